@@ -80,7 +80,9 @@ struct flatcc_options {
     int cgen_builder;
     int cgen_verifier;
     int cgen_json_parser;
+    int cgen_json_parser_hash;
     int cgen_json_printer;
+    int cgen_json_printer_table;
     int cgen_recursive;
     int cgen_spacing;
     int cgen_no_conflicts;
@@ -585,6 +585,14 @@ uint16_t flatcc_builder_get_buffer_alignment(flatcc_builder_t *B);
  */
 int flatcc_builder_get_level(flatcc_builder_t *B);
 
+/**
+ * Exits all frames above `level` without ending them, for example to
+ * give up on a partially built table after a parse error. Objects
+ * already emitted remain in the buffer but are not referenced. User
+ * frames are not affected.
+ */
+void flatcc_builder_abandon_to_level(flatcc_builder_t *B, int level);
+
 /**
  * Setting the max level triggers a failure on start of new nestings
  * when the level is reached. May be used to protect recursive descend
@@ -22,6 +22,29 @@ extern "C" {
 #define PDIAGNOSTIC_IGNORE_UNUSED
 #include "flatcc/portable/pdiagnostic_push.h"
 
+/* Used for job state when parsing table vectors in parallel. */
+#ifndef FLATCC_JSON_PARSER_ALLOC
+#define FLATCC_JSON_PARSER_ALLOC(n) FLATCC_ALLOC(n)
+#endif
+
+#ifndef FLATCC_JSON_PARSER_FREE
+#define FLATCC_JSON_PARSER_FREE(p) FLATCC_FREE(p)
+#endif
+
+#ifndef FLATCC_JSON_PARSER_REALLOC
+#define FLATCC_JSON_PARSER_REALLOC(p, n) FLATCC_REALLOC(p, n)
+#endif
+
+/* Default input size of each job when parsing table vectors in parallel. */
+#ifndef FLATCC_JSON_PARSER_PARALLEL_CHUNK
+#define FLATCC_JSON_PARSER_PARALLEL_CHUNK (1 << 20)
+#endif
+
+/* Default number of jobs run at a time when parsing NDJSON in parallel. */
+#ifndef FLATCC_JSON_PARSER_PARALLEL_BATCH
+#define FLATCC_JSON_PARSER_PARALLEL_BATCH 16
+#endif
+
 typedef uint32_t flatcc_json_parser_flags_t;
 static const flatcc_json_parser_flags_t flatcc_json_parser_f_skip_unknown = 1;
 static const flatcc_json_parser_flags_t flatcc_json_parser_f_force_add = 2;
@@ -79,6 +102,44 @@ const char *flatcc_json_parser_error_string(int err);
 #define flatcc_json_parser_ok flatcc_json_parser_error_ok
 #define flatcc_json_parser_eof flatcc_json_parser_error_eof
 
+/*
+ * Counters updated while parsing, see `flatcc_json_parser_get_stats`.
+ * `direct_strings / strings` is the fraction of strings created from
+ * the input in a single copy because they hold no escapes.
+ */
+typedef struct flatcc_json_parser_stats {
+    /* Strings created by `flatcc_json_parser_build_string`. */
+    size_t strings;
+    /* Strings without escapes, created directly from the input. */
+    size_t direct_strings;
+    /* Union values parsed again because their type came after them. */
+    size_t union_reparses;
+} flatcc_json_parser_stats_t;
+
+/*
+ * Parallel parsing of large table vectors, see
+ * `flatcc_json_parser_table_as_root_parallel`.
+ *
+ * The runtime does not create threads. `run` must call `job(job_context, i)`
+ * once for every `i` in `[0, count)`, in any order and possibly
+ * concurrently, and only return when all calls have returned.
+ */
+typedef void flatcc_json_parser_job_f(void *job_context, size_t index);
+typedef void flatcc_json_parser_run_f(void *run_context,
+        flatcc_json_parser_job_f *job, void *job_context, size_t count);
+
+typedef struct flatcc_json_parser_parallel {
+    flatcc_json_parser_run_f *run;
+    void *run_context;
+    /* Approximate input size of each job, 0 for the default. */
+    size_t chunk_size;
+    /*
+     * Number of jobs passed to each `run` call by
+     * `flatcc_json_parser_ndjson_parallel`, 0 for the default.
+     */
+    size_t batch_size;
+} flatcc_json_parser_parallel_t;
+
 /*
  * The struct may be zero initialized in which case the line count will
  * start at line zero, or the line may be set to 1 initially. The ctx
@@ -103,6 +164,11 @@ struct flatcc_json_parser_ctx {
     const char *error_loc;
     /* Set at end of successful parse. */
     const char *end_loc;
+    flatcc_json_parser_stats_t stats;
+    /* Optional, see `flatcc_json_parser_table_as_root_parallel`. */
+    const flatcc_json_parser_parallel_t *parallel;
+    /* Set while a union value is parsed before its type is known. */
+    int speculating;
 };
 
 static inline int flatcc_json_parser_get_error(flatcc_json_parser_t *ctx)
@@ -110,6 +176,16 @@ static inline int flatcc_json_parser_get_error(flatcc_json_parser_t *ctx)
     return ctx->error;
 }
 
+/*
+ * Stats are reset by `flatcc_json_parser_init` and therefore cover a
+ * single root parse, except for NDJSON parsing where they cover all
+ * tables parsed with the same context.
+ */
+static inline const flatcc_json_parser_stats_t *flatcc_json_parser_get_stats(flatcc_json_parser_t *ctx)
+{
+    return &ctx->stats;
+}
+
 static inline void flatcc_json_parser_init(flatcc_json_parser_t *ctx, flatcc_builder_t *B, const char *buf, const char *end, flatcc_json_parser_flags_t flags)
 {
     memset(ctx, 0, sizeof(*ctx));
@@ -176,6 +252,9 @@ const char *flatcc_json_parser_char_array(flatcc_json_parser_t *ctx,
 /*
  * Creates a string. Returns *ref == 0 on unrecoverable error or
  * sets *ref to a valid new string reference.
+ *
+ * Strings without escapes are created with a single copy from the
+ * input, others are assembled piecewise in the builder.
  */
 const char *flatcc_json_parser_build_string(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, flatcc_builder_ref_t *ref);
@@ -315,6 +394,111 @@ static inline uint64_t flatcc_json_parser_symbol_part(const char *buf, const cha
     return flatcc_json_parser_symbol_part_ext(buf, end);
 }
 
+/*
+ * Perfect hash lookup of field names and enum constants used by parsers
+ * generated with `flatcc --json-parser-hash` instead of the default
+ * trie. The compiler computes the same hash and chooses per bucket
+ * displacements so all names of a type land in distinct slots. The
+ * generated parser then confirms the name in the slot with a single
+ * compare, and the usual match functions check the termination.
+ */
+#define FLATCC_JSON_PARSER_HASH_MULTIPLIER UINT64_C(0x9e3779b97f4a7c15)
+
+#define __flatcc_json_parser_bytes(c) (UINT64_C(0x0101010101010101) * (c))
+
+/* Sets the high bit of each byte in `x` that is not in `[A-Za-z0-9_]`. */
+static inline uint64_t __flatcc_json_parser_symbol_mask(uint64_t x)
+{
+    uint64_t y, v, m;
+
+    y = x & __flatcc_json_parser_bytes(0x7f);
+    /* Digits: 0x2f < y < 0x3a. */
+    m = (__flatcc_json_parser_bytes(185) - y) & (y + __flatcc_json_parser_bytes(80));
+    /* Letters folded to lower case: 0x60 < y < 0x7b. */
+    y |= __flatcc_json_parser_bytes(0x20);
+    m |= (__flatcc_json_parser_bytes(250) - y) & (y + __flatcc_json_parser_bytes(31));
+    /* Underscore. */
+    v = x ^ __flatcc_json_parser_bytes(0x5f);
+    m |= ~(((v & __flatcc_json_parser_bytes(0x7f)) + __flatcc_json_parser_bytes(0x7f)) | v);
+    /* Bytes above 0x7f are not identifier characters. */
+    return ~(m & ~x) & __flatcc_json_parser_bytes(0x80);
+}
+
+/* Leading bytes before the first marked byte in a non-zero mask. */
+static inline size_t __flatcc_json_parser_mask_lead(uint64_t m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_clzll(m) >> 3;
+#else
+    size_t n = 0;
+
+    while (!(m & UINT64_C(0x8000000000000000))) {
+        m <<= 8;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/*
+ * Hashes the leading run of identifier characters, which is all a
+ * schema name can hold, and returns its length in `len`. The name is
+ * read as big endian words like `flatcc_json_parser_symbol_part` with
+ * the last word zero padded.
+ */
+static inline uint64_t flatcc_json_parser_symbol_hash(const char *buf, const char *end, size_t *len)
+{
+    const char *k = buf;
+    uint64_t x, m, h = 0;
+    size_t n = 0;
+    char c;
+
+    while (end - k >= 8) {
+        memcpy(&x, k, 8);
+        x = be64toh(x);
+        m = __flatcc_json_parser_symbol_mask(x);
+        if (m) {
+            n = __flatcc_json_parser_mask_lead(m);
+            if (n) {
+                h = (h ^ (x & ~(UINT64_MAX >> (n * 8)))) * FLATCC_JSON_PARSER_HASH_MULTIPLIER;
+            }
+            *len = (size_t)(k - buf) + n;
+            return h ^ (h >> 32);
+        }
+        h = (h ^ x) * FLATCC_JSON_PARSER_HASH_MULTIPLIER;
+        k += 8;
+    }
+    while (k + n != end) {
+        c = k[n];
+        if (c == '_' || (c >= '0' && c <= '9')) {
+            ++n;
+            continue;
+        }
+        c |= 0x20;
+        if (c >= 'a' && c <= 'z') {
+            ++n;
+            continue;
+        }
+        break;
+    }
+    if (n) {
+        h = (h ^ flatcc_json_parser_symbol_part_ext(k, k + n)) * FLATCC_JSON_PARSER_HASH_MULTIPLIER;
+    }
+    *len = (size_t)(k - buf) + n;
+    return h ^ (h >> 32);
+}
+
+static inline size_t flatcc_json_parser_symbol_slot(uint64_t h,
+        const uint16_t *disp, size_t buckets, size_t slots)
+{
+    uint64_t d = disp[(size_t)(((h & UINT32_MAX) * buckets) >> 32)];
+
+    h ^= (d + 1) * FLATCC_JSON_PARSER_HASH_MULTIPLIER;
+    h ^= h >> 29;
+    h *= FLATCC_JSON_PARSER_HASH_MULTIPLIER;
+    return (size_t)(((h >> 32) * slots) >> 32);
+}
+
 /* Don't allow space in dot notation neither inside nor outside strings. */
 static inline const char *flatcc_json_parser_match_scope(flatcc_json_parser_t *ctx, const char *buf, const char *end, int pos)
 {
@@ -817,6 +1001,30 @@ __flatcc_json_parser_define_symbolic_integral_parser(double, double)
 const char *flatcc_json_parser_build_uint8_vector_base64(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, flatcc_builder_ref_t *ref, int urlsafe);
 
+/*
+ * Adds a run of numeric elements to a scalar vector opened with
+ * `flatcc_builder_start_vector` after `flatcc_json_parser_array_start`.
+ * The vector is extended `FLATCC_JSON_PARSE_VECTOR_CHUNK` elements at a
+ * time and truncated when the run ends, so there are no builder calls
+ * per element. Returns at the first element that does not start like a
+ * number, such as a symbolic constant, with `more` still set so the
+ * remaining elements can be parsed one at a time.
+ */
+#define __flatcc_json_parser_declare_extend_vector(type)                    \
+const char *flatcc_json_parser_extend_ ## type ## _vector(                   \
+        flatcc_json_parser_t *ctx, const char *buf, const char *end, int *more);
+
+__flatcc_json_parser_declare_extend_vector(uint64)
+__flatcc_json_parser_declare_extend_vector(uint32)
+__flatcc_json_parser_declare_extend_vector(uint16)
+__flatcc_json_parser_declare_extend_vector(uint8)
+__flatcc_json_parser_declare_extend_vector(int64)
+__flatcc_json_parser_declare_extend_vector(int32)
+__flatcc_json_parser_declare_extend_vector(int16)
+__flatcc_json_parser_declare_extend_vector(int8)
+__flatcc_json_parser_declare_extend_vector(float)
+__flatcc_json_parser_declare_extend_vector(double)
+
 /*
  * This doesn't do anything other than validate and advance past
  * a JSON value which may use unquoted symbols.
@@ -834,6 +1042,27 @@ const char *flatcc_json_parser_generic_json(flatcc_json_parser_t *ctx, const cha
 typedef const char *flatcc_json_parser_table_f(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, flatcc_builder_ref_t *pref);
 
+const char *flatcc_json_parser_parallel_tables_ext(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, int *more, flatcc_json_parser_table_f *parser);
+
+/*
+ * Called by generated parsers on table vectors with the offset vector
+ * started and after `flatcc_json_parser_array_start`. When the context
+ * has a parallel configuration and the array spans at least two jobs,
+ * all elements are parsed by jobs and added to the offset vector, and
+ * the array end is parsed. Otherwise nothing is parsed and the caller
+ * parses the elements one at a time. This is also the case when any
+ * job fails, so errors are reported as without parallel parsing.
+ */
+static inline const char *flatcc_json_parser_parallel_tables(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, int *more, flatcc_json_parser_table_f *parser)
+{
+    if (!ctx->parallel || !*more) {
+        return buf;
+    }
+    return flatcc_json_parser_parallel_tables_ext(ctx, buf, end, more, parser);
+}
+
 /* Parses a JSON struct. */
 typedef const char *flatcc_json_parser_struct_f(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, flatcc_builder_ref_t *pref);
@@ -856,6 +1085,20 @@ const char *flatcc_json_parser_union(flatcc_json_parser_t *ctx,
         flatbuffers_voffset_t id, size_t handle,
         flatcc_json_parser_union_f *union_parser);
 
+/*
+ * Same as `flatcc_json_parser_union`, but when the value comes before
+ * its type it is parsed as each of the zero terminated `table_types`
+ * in turn until one succeeds. If the type that follows is the one
+ * that succeeded, the value is not parsed again. Otherwise the value
+ * is reparsed with the right type and the speculative table remains
+ * unreferenced in the buffer. Union values nested inside a speculative
+ * parse are skipped and reparsed as usual.
+ */
+const char *flatcc_json_parser_union_speculative(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, size_t union_index,
+        flatbuffers_voffset_t id, size_t handle,
+        flatcc_json_parser_union_f *union_parser, const uint8_t *table_types);
+
 const char *flatcc_json_parser_union_type(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, size_t union_index,
         flatbuffers_voffset_t id, size_t handle,
@@ -891,6 +1134,97 @@ int flatcc_json_parser_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *
         const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
         flatcc_json_parser_table_f *parser);
 
+/*
+ * Similar to `flatcc_json_parser_table_as_root` but parses large table
+ * vectors, such as a single huge array in the root table, with jobs run
+ * by `parallel->run`, typically on a thread pool.
+ *
+ * The array is first scanned for element boundaries a block at a time,
+ * using SSE2 or AVX2 when available, and split into ranges of about
+ * `parallel->chunk_size` bytes (default `FLATCC_JSON_PARSER_PARALLEL_CHUNK`).
+ * Each job parses a range into its own builder and the finished buffers
+ * are copied into the vector in order. FlatBuffer offsets are relative
+ * so the tables need no relocation, but vtables are not shared between
+ * jobs, which makes the buffer slightly larger than a serial parse.
+ *
+ * Table vectors inside the parsed ranges are parsed by the job that
+ * holds them, so elements are never split further.
+ */
+int flatcc_json_parser_table_as_root_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        const flatcc_json_parser_parallel_t *parallel);
+
+/*
+ * Newline delimited JSON (NDJSON)
+ *
+ * Receives each finished buffer of an NDJSON parse. `buf` is only valid
+ * during the call. A non-zero return stops the parse and is returned
+ * as is.
+ */
+typedef int flatcc_json_parser_emit_f(void *emit_context, const void *buf, size_t bufsiz);
+
+/*
+ * Parses `buf` as one JSON table per line, reusing the builder and the
+ * parser context for each line. Empty and whitespace only lines are
+ * skipped. The flag `flatcc_json_parser_f_with_size` is always added
+ * so the emitted buffers can be stored back to back and read in order.
+ *
+ * With the default emitter, each buffer is passed to `emit` and the
+ * builder is reset before the next line. The buffer is passed without
+ * copying unless it spans several emitter pages. If `emit` is null,
+ * the builder is still reset between lines, which suits a custom
+ * emitter that forwards each buffer elsewhere as it is built.
+ *
+ * `count` may be null, otherwise it receives the number of buffers
+ * emitted. Parsing stops at the first error. Then `ctx` (if not null)
+ * holds the error with `ctx->line` and `ctx->pos` relative to the
+ * start of `buf` and `ctx->start` pointing to the failing line.
+ */
+int flatcc_json_parser_ndjson(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count);
+
+/*
+ * Splits NDJSON input into at most `parts` ranges of roughly equal size
+ * for independent parsing, typically by `flatcc_json_parser_ndjson` in
+ * separate threads with a builder each. Each range ends after a
+ * newline or at the end of the input so no line is split. `offsets`
+ * must hold `parts + 1` entries and receives the start of each range
+ * followed by `bufsiz`. Returns the number of non-empty ranges, which
+ * can be fewer than `parts` for short inputs or long lines, and 0 when
+ * `parts` is 0.
+ *
+ * Errors reported for a range have line numbers relative to that
+ * range. Add the number of newlines preceding the range to get the
+ * line in the full input. Emitted buffers of consecutive ranges are in
+ * input order when concatenated in range order.
+ */
+size_t flatcc_json_parser_ndjson_split(const char *buf, size_t bufsiz,
+        size_t parts, size_t *offsets);
+
+/*
+ * Similar to `flatcc_json_parser_ndjson` but splits the input at
+ * newlines into ranges of about `parallel->chunk_size` bytes, each
+ * parsed by a job with its own builder and run by `parallel->run`.
+ * Jobs are run `parallel->batch_size` at a time (default
+ * `FLATCC_JSON_PARSER_PARALLEL_BATCH`). The buffers of a batch are held
+ * in memory until the batch is done, and then passed to `emit` in input
+ * order, so `emit` is never called concurrently and sees the same
+ * buffers as a serial parse.
+ *
+ * Errors are reported as by `flatcc_json_parser_ndjson`, with line
+ * numbers relative to the start of `buf` and all buffers before the
+ * failing line emitted. `B` is only used for short inputs, which are
+ * parsed serially, and when `parallel` is null or has no `run`.
+ */
+int flatcc_json_parser_ndjson_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count,
+        const flatcc_json_parser_parallel_t *parallel);
+
 /*
  * Similar to `flatcc_json_parser_table_as_root` but parses a struct as
  * root.
@@ -28,6 +28,20 @@ extern "C" {
 /* Initial size that grows exponentially. */
 #define FLATCC_JSON_PRINT_DYN_BUFFER_SIZE 4096
 
+/* Default number of elements printed by each job when printing table vectors in parallel. */
+#ifndef FLATCC_JSON_PRINT_PARALLEL_CHUNK
+#define FLATCC_JSON_PRINT_PARALLEL_CHUNK 4096
+#endif
+
+/*
+ * Default number of jobs run at a time when printing table vectors in
+ * parallel. A few jobs per worker keeps workers busy while bounding the
+ * printed text held in memory.
+ */
+#ifndef FLATCC_JSON_PRINT_PARALLEL_BATCH
+#define FLATCC_JSON_PRINT_PARALLEL_BATCH 16
+#endif
+
 
 #include <stdlib.h>
 #include <string.h>
@@ -52,7 +66,9 @@ extern "C" {
      * When the output was larger than the available fixed length buffer,     \
      * or dynamic allocation could not grow the buffer sufficiently.        \
      */                                                                     \
-    XX(overflow,                "overflow")
+    XX(overflow,                "overflow")                                 \
+    /* When a write callback or file descriptor write failed. */            \
+    XX(write_failed,            "write failed")
 
 enum flatcc_json_printer_error_no {
 #define XX(no, str) flatcc_json_printer_error_##no,
@@ -66,6 +82,65 @@ typedef struct flatcc_json_printer_ctx flatcc_json_printer_t;
 
 typedef void flatcc_json_printer_flush_f(flatcc_json_printer_t *ctx, int all);
 
+/*
+ * Writes `len` bytes at `data`, or completes all pending writes when
+ * `data` is null. Returns non-zero on failure. See `init_writer`.
+ */
+typedef int flatcc_json_printer_write_f(void *write_context, const char *data, size_t len);
+
+/*
+ * A chunk of output for `init_iovec`. Laid out as `struct iovec` on
+ * POSIX systems so an array can be passed to `writev` as is.
+ */
+typedef struct flatcc_json_printer_iovec {
+    void *iov_base;
+    size_t iov_len;
+} flatcc_json_printer_iovec_t;
+
+/*
+ * Receives `iovcnt` filled chunks in output order. Returns non-zero on
+ * failure. See `init_iovec`.
+ */
+typedef int flatcc_json_printer_iovec_f(void *iovec_context,
+        const flatcc_json_printer_iovec_t *iov, int iovcnt);
+
+/*
+ * Parallel printing of large table vectors, see
+ * `flatcc_json_printer_set_parallel`.
+ *
+ * The runtime does not create threads. `run` must call `job(job_context, i)`
+ * once for every `i` in `[0, count)`, in any order and possibly
+ * concurrently, and only return when all calls have returned.
+ */
+typedef void flatcc_json_printer_job_f(void *job_context, size_t index);
+typedef void flatcc_json_printer_run_f(void *run_context,
+        flatcc_json_printer_job_f *job, void *job_context, size_t count);
+
+typedef struct flatcc_json_printer_parallel {
+    flatcc_json_printer_run_f *run;
+    void *run_context;
+    /* Number of elements printed by each job, 0 for the default. */
+    size_t chunk_size;
+    /* Number of jobs passed to each `run` call, 0 for the default. */
+    size_t batch_size;
+} flatcc_json_printer_parallel_t;
+
+/*
+ * Projection, see `flatcc_json_printer_set_projection`.
+ *
+ * A node selects fields of a table by field id. A selected table field
+ * with a null child prints its entire subtree, otherwise the child
+ * selects the fields of the table, or of each table in a vector, union
+ * or nested buffer. Other fields print in full when selected.
+ */
+typedef struct flatcc_json_printer_projection flatcc_json_printer_projection_t;
+struct flatcc_json_printer_projection {
+    /* Bit `id % 8` of `fields[id / 8]` is set for selected ids below `size`. */
+    uint8_t *fields;
+    flatcc_json_printer_projection_t **children;
+    size_t size;
+};
+
 struct flatcc_json_printer_ctx {
     char *buf;
     size_t size;
@@ -84,6 +159,23 @@ struct flatcc_json_printer_ctx {
 
     void *fp;
     flatcc_json_printer_flush_f *flush;
+
+    /* Used by `init_writer`. */
+    flatcc_json_printer_write_f *write;
+    void *write_context;
+    char *back_buf;
+
+    /* Used by `init_iovec`, with `write_context` for the callback. */
+    flatcc_json_printer_iovec_f *iovec;
+    char *const *chunks;
+    flatcc_json_printer_iovec_t *iov;
+    int chunk_count;
+    int iov_count;
+
+    /* Optional, see `flatcc_json_printer_set_parallel`. */
+    const flatcc_json_printer_parallel_t *parallel;
+    /* Optional, see `flatcc_json_printer_set_projection`. */
+    const flatcc_json_printer_projection_t *projection;
 };
 
 static inline void flatcc_json_printer_set_error(flatcc_json_printer_t *ctx, int err)
@@ -110,6 +202,12 @@ static inline int flatcc_json_printer_get_error(flatcc_json_printer_t *ctx)
  */
 static inline void flatcc_json_printer_reset(flatcc_json_printer_t *ctx)
 {
+    if (ctx->chunks) {
+        /* `init_iovec` starts over in the first chunk. */
+        ctx->iov_count = 0;
+        ctx->buf = ctx->chunks[0];
+        ctx->pflush = ctx->buf + ctx->flush_size;
+    }
     ctx->p = ctx->buf;
     ctx->level = 0;
     ctx->total = 0;
@@ -161,6 +259,108 @@ int flatcc_json_printer_init(flatcc_json_printer_t *ctx, void *fp);
  */
 int flatcc_json_printer_init_buffer(flatcc_json_printer_t *ctx, char *buffer, size_t buffer_size);
 
+/*
+ * Prints to two alternating buffers of `buffer_size` bytes and passes
+ * each filled buffer to `write` in whole, including content printed
+ * past the flush limit, so unlike `init` nothing is copied back to the
+ * start of the buffer after a write. Writes are therefore not of a
+ * fixed size.
+ *
+ * Printing continues in the other buffer while `write` may still be
+ * writing the first, so `write` can queue the data, for example to an
+ * I/O thread, and return immediately, but it must be done with the
+ * data when its next call returns. On `flush`, `write` is called with
+ * the remaining content and then with null `data` and must complete
+ * all pending writes before returning. A non-zero return from `write`
+ * sets the `write_failed` error.
+ *
+ * If `buffer_size` is 0, `FLATCC_JSON_PRINT_BUFFER_SIZE` is used. The
+ * size is rounded up to twice the reserved size if too small.
+ *
+ * Returns -1 on alloc error (no cleanup needed), or 0 on success.
+ * Eventually the clear method must be called to return memory.
+ *
+ * `set_flags` and related may be called subsequently to modify
+ * behavior.
+ */
+int flatcc_json_printer_init_writer(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_write_f *write, void *write_context, size_t buffer_size);
+
+/*
+ * Prints to the file descriptor `fd` with blocking writes using
+ * `init_writer` with the default buffer size. This bypasses stdio
+ * buffering entirely. The file descriptor is not affected by reset or
+ * clear and should be closed manually.
+ *
+ * Returns -1 if file descriptors are not supported on the platform or
+ * on alloc error (no cleanup needed), or 0 on success. Eventually the
+ * clear method must be called to return memory.
+ */
+int flatcc_json_printer_init_fd(flatcc_json_printer_t *ctx, int fd);
+
+/*
+ * Measures the printed size without keeping the output. Content is
+ * formatted into a small buffer that is discarded on every flush, so
+ * printing a buffer returns its exact printed size, also available
+ * from `flatcc_json_printer_total`, without growing memory. Formatting
+ * settings must match those of the real print for the size to match.
+ *
+ * Measuring costs about as much as printing, so it pays off when the
+ * size must be known up front, such as for a length header or a fixed
+ * size arena, rather than to save the reallocation of a dynamic
+ * buffer which is comparatively cheap.
+ *
+ * Returns -1 on alloc error (no cleanup needed), or 0 on success.
+ * Eventually the clear method must be called to return memory.
+ */
+int flatcc_json_printer_init_measure(flatcc_json_printer_t *ctx);
+
+/*
+ * Prints directly into a ring of `chunk_count` caller owned chunks of
+ * `chunk_size` bytes each, for example to stream a response with
+ * `writev` without a contiguous buffer or copies. A chunk is complete
+ * when printing passes `chunk_size - FLATCC_JSON_PRINT_RESERVE` bytes,
+ * and printing continues in the next chunk. Chunks are therefore not
+ * filled to the same length.
+ *
+ * With an `iovec` callback, the chunks are passed to it when all are
+ * complete and on `flush`, which also passes the last partial chunk,
+ * and the ring starts over when it returns. A non-zero return sets the
+ * `write_failed` error. Without a callback, `get_iovec` returns the
+ * chunks after printing, and filling the ring sets the `overflow` error
+ * and starts over, losing earlier content as `init_buffer` does.
+ * `reset` starts over in the first chunk.
+ *
+ * The chunks are not affected by reset or clear and must stay valid
+ * until clear.
+ *
+ * Returns -1 if there are no chunks, if `chunk_size` is less than
+ * twice `FLATCC_JSON_PRINT_RESERVE`, or on alloc error (no cleanup
+ * needed), or 0 on success. Eventually the clear method must be called
+ * to return memory.
+ */
+int flatcc_json_printer_init_iovec(flatcc_json_printer_t *ctx,
+        char *const *chunks, int chunk_count, size_t chunk_size,
+        flatcc_json_printer_iovec_f *iovec, void *iovec_context);
+
+/*
+ * Returns the chunks printed with `init_iovec` since the ring last
+ * started over, including the current partial chunk, and their number
+ * in `iovcnt`. Valid until the next operation.
+ */
+const flatcc_json_printer_iovec_t *flatcc_json_printer_get_iovec(
+        flatcc_json_printer_t *ctx, int *iovcnt);
+
+/*
+ * Size of a buffer for `init_buffer` or `init_dynamic_buffer` that
+ * holds `printed_size` bytes of output and the terminating zero
+ * without overflow or reallocation, for example after measuring.
+ */
+static inline size_t flatcc_json_printer_buffer_size_for(size_t printed_size)
+{
+    return printed_size + FLATCC_JSON_PRINT_RESERVE + 1;
+}
+
 /*
  * Returns the current buffer pointer and also the content size in
  * `buffer_size` if it is null. The operation is not very useful for
@@ -281,6 +481,67 @@ static inline void flatcc_json_printer_set_flags(flatcc_json_printer_t *ctx, fla
     }
 }
 
+/*
+ * Prints table vectors of at least two chunks with jobs run by
+ * `parallel->run`, typically on a thread pool. Each job prints about
+ * `parallel->chunk_size` elements (default
+ * `FLATCC_JSON_PRINT_PARALLEL_CHUNK`) into a dynamic buffer of its own
+ * with the same settings and indentation level as `ctx`. Jobs are run
+ * `parallel->batch_size` at a time (default
+ * `FLATCC_JSON_PRINT_PARALLEL_BATCH`), typically a few per worker, and
+ * the buffers of each batch are written to `ctx` in order and freed
+ * before the next batch starts, so at most one batch of printed text is
+ * held in memory. The output is the same as without parallel printing.
+ * If any job fails, the rest of the vector from the start of its batch
+ * is printed serially so errors are reported as usual.
+ *
+ * Table vectors inside the elements are printed by the job that holds
+ * them. The configuration is not copied and must outlive printing.
+ * Call after init since init clears the context, and pass null to
+ * disable.
+ */
+static inline void flatcc_json_printer_set_parallel(flatcc_json_printer_t *ctx,
+        const flatcc_json_printer_parallel_t *parallel)
+{
+    ctx->parallel = parallel && parallel->run ? parallel : 0;
+}
+
+/*
+ * Only prints the fields selected by `projection` when printing a table
+ * as root or as NDJSON, and skips unselected fields without reading
+ * their content, so large unselected subtrees cost nothing beyond a
+ * bit test. Select fields with `flatcc_json_printer_projection_add` and
+ * the generated `<Table>_<field>_field_id` constants. Union fields are
+ * selected by their own id and print with their type field. Forced
+ * defaults are only printed for selected fields.
+ *
+ * The projection is not copied and must outlive printing. Call after
+ * init since init clears the context, and pass null to print all
+ * fields.
+ */
+static inline void flatcc_json_printer_set_projection(flatcc_json_printer_t *ctx,
+        const flatcc_json_printer_projection_t *projection)
+{
+    ctx->projection = projection;
+}
+
+/* Initializes an empty projection which selects no fields. */
+void flatcc_json_printer_projection_init(flatcc_json_printer_projection_t *projection);
+
+/*
+ * Selects the field at the end of a path of `depth` field ids where
+ * each id names a field in the table of the field before it, such as
+ * `{ Monster_testarrayoftables_field_id, Monster_name_field_id }`.
+ * Only table, table vector, union and nested flatbuffer fields hold
+ * tables, so only these continue a path. A field selected by a shorter
+ * path prints in full and is not narrowed by longer paths. Returns -1
+ * on negative ids or allocation failure.
+ */
+int flatcc_json_printer_projection_add(flatcc_json_printer_projection_t *projection,
+        const int *path, size_t depth);
+
+/* Frees memory held by the projection and its children. */
+void flatcc_json_printer_projection_clear(flatcc_json_printer_projection_t *projection);
 
 /*
  * Detects if the conctext type uses dynamically allocated memory
@@ -458,6 +719,8 @@ struct flatcc_json_printer_table_descriptor {
     int vsize;
     int ttl;
     int count;
+    /* Fields to print, or null for all. */
+    const flatcc_json_printer_projection_t *projection;
 };
 
 typedef struct flatcc_json_printer_union_descriptor flatcc_json_printer_union_descriptor_t;
@@ -466,6 +729,8 @@ struct flatcc_json_printer_union_descriptor {
     const void *member;
     int ttl;
     uint8_t type;
+    /* Fields to print when the member is a table, or null for all. */
+    const flatcc_json_printer_projection_t *projection;
 };
 
 typedef void flatcc_json_printer_table_f(flatcc_json_printer_t *ctx,
@@ -685,6 +950,25 @@ int flatcc_json_printer_struct_as_root(flatcc_json_printer_t *ctx,
         const void *buf, size_t bufsiz, const char *fid,
         flatcc_json_printer_struct_f *pf);
 
+/*
+ * Newline delimited JSON (NDJSON)
+ *
+ * Prints each element of the table vector field `id` in the root table
+ * as a compact JSON object on a line of its own, regardless of the
+ * indent setting, and flushes after each line so a line oriented
+ * consumer can start on a record as soon as it is complete. With a
+ * file, writer or fd context memory stays bounded by the printer
+ * buffer however long the vector is. Nothing is printed when the field
+ * is absent. Generated code has `<Table>_<field>_print_ndjson` for
+ * every table vector field.
+ *
+ * Returns the printed size as `flatcc_json_printer_table_as_root`, or
+ * -1 on error.
+ */
+int flatcc_json_printer_table_vector_as_ndjson(flatcc_json_printer_t *ctx,
+        const void *buf, size_t bufsiz, const char *fid, int id,
+        flatcc_json_printer_table_f *pf);
+
 /*
  * Call before and after enum flags to ensure proper quotation. Enum
  * quotes may be configured runtime, but regardless of this, multiple
@@ -781,6 +1065,78 @@ void flatcc_json_printer_union_struct(flatcc_json_printer_t *ctx,
 void flatcc_json_printer_union_string(flatcc_json_printer_t *ctx,
         flatcc_json_printer_union_descriptor_t *ud);
 
+/*
+ * Table driven printing
+ *
+ * With `flatcc --json-printer-table` the generated table printers do
+ * not call a field function per schema field. Instead each table gets a
+ * static const array of field descriptors in field id order, and
+ * `flatcc_json_printer_table_fields` walks it, skipping absent fields
+ * before dispatching to the same field functions as above, so the
+ * output is identical. This trades a little dispatch for less
+ * generated machine code on large schemas.
+ *
+ * `pf` is cast back to the printer type the kind expects. `value` holds
+ * the default of scalar and enum fields as a 64-bit integer, or the
+ * bits of the float or double default, the struct size of struct
+ * vectors and the urlsafe flag of base64 vectors. A union or union
+ * vector is preceded by a `union_type` entry with the type printer at
+ * the id of the type field.
+ */
+typedef void flatcc_json_printer_generic_f(void);
+
+enum flatcc_json_printer_field_kind {
+    flatcc_json_printer_kind_scalar = 0,
+    flatcc_json_printer_kind_optional,
+    flatcc_json_printer_kind_enum,
+    flatcc_json_printer_kind_enum_optional,
+    flatcc_json_printer_kind_vector,
+    flatcc_json_printer_kind_enum_vector,
+    flatcc_json_printer_kind_base64_vector,
+    flatcc_json_printer_kind_string,
+    flatcc_json_printer_kind_string_vector,
+    flatcc_json_printer_kind_struct,
+    flatcc_json_printer_kind_struct_vector,
+    flatcc_json_printer_kind_table,
+    flatcc_json_printer_kind_table_vector,
+    flatcc_json_printer_kind_union_type,
+    flatcc_json_printer_kind_union,
+    flatcc_json_printer_kind_union_vector,
+    flatcc_json_printer_kind_nested_table,
+    flatcc_json_printer_kind_nested_struct
+};
+
+/* Scalar type of scalar, enum and vector kinds, otherwise 0. */
+enum flatcc_json_printer_field_type {
+    flatcc_json_printer_type_uint8 = 0,
+    flatcc_json_printer_type_uint16,
+    flatcc_json_printer_type_uint32,
+    flatcc_json_printer_type_uint64,
+    flatcc_json_printer_type_int8,
+    flatcc_json_printer_type_int16,
+    flatcc_json_printer_type_int32,
+    flatcc_json_printer_type_int64,
+    flatcc_json_printer_type_bool,
+    flatcc_json_printer_type_float,
+    flatcc_json_printer_type_double
+};
+
+typedef struct flatcc_json_printer_field flatcc_json_printer_field_t;
+
+struct flatcc_json_printer_field {
+    const char *name;
+    flatcc_json_printer_generic_f *pf;
+    uint64_t value;
+    uint16_t id;
+    uint16_t len;
+    uint8_t kind;
+    uint8_t type;
+};
+
+void flatcc_json_printer_table_fields(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        const flatcc_json_printer_field_t *fields, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,29 @@ extern "C" {
 #define FLATCC_USE_GRISU3 1
 #endif
 
+/*
+ * Shortest round-trip printing of float and double using the Schubfach
+ * algorithm. When enabled it replaces grisu3 for printing, but not for
+ * parsing. Unlike grisu3 it never falls back to 17 digit sprintf output
+ * and it prints floats with the shortest digits of the float rather
+ * than those of the float converted to double, so 0.1f prints as 0.1.
+ * Disable to print with grisu3, or sprintf if FLATCC_USE_GRISU3 is
+ * also disabled.
+ */
+#ifndef FLATCC_USE_SCHUBFACH
+#define FLATCC_USE_SCHUBFACH 1
+#endif
+
+/*
+ * Fast path for parsing plain decimal numbers with at most 19
+ * significant digits using the Eisel-Lemire algorithm. Other numbers
+ * and the rare ambiguous cases fall back to grisu3 or strtod. Integer
+ * and decimal digits are converted 8 at a time either way.
+ */
+#ifndef FLATCC_USE_EISEL_LEMIRE
+#define FLATCC_USE_EISEL_LEMIRE 1
+#endif
+
 /*
  * This requires compiler that has enabled marc=native or similar so
  * __SSE4_2__ flag is defined. Otherwise it will have no effect.
@@ -43,11 +66,33 @@ extern "C" {
  * In conclusion SSE doesn't add a lot to JSON space handling at least.
  *
  * Disabled by default, but can be overriden by build system.
+ * FLATCC_USE_SSE2 takes precedence when both are available.
  */
 #ifndef FLATCC_USE_SSE4_2
 #define FLATCC_USE_SSE4_2 0
 #endif
 
+/*
+ * The JSON parser classifies whitespace and string content 32 bytes
+ * at a time with SSE2 and 64 bytes at a time with AVX2. SSE2 is used
+ * when the compiler targets it, which x86-64 always does. AVX2 is used
+ * when targeted, or selected at runtime on GCC and Clang when the CPU
+ * supports it. This matters mostly for long strings and deep
+ * indentation. Short strings and compact JSON take the scalar path.
+ * The JSON printer uses the same settings to find bytes that must be
+ * escaped in strings and char arrays.
+ * Both also encode and decode base64 with AVX2 when both are enabled.
+ *
+ * See also `include/flatcc/portable/psimd.h`.
+ */
+#ifndef FLATCC_USE_SSE2
+#define FLATCC_USE_SSE2 1
+#endif
+
+#ifndef FLATCC_USE_AVX2
+#define FLATCC_USE_AVX2 1
+#endif
+
 /*
  * The verifier only reports yes and no. The following setting
  * enables assertions in debug builds. It must be compiled into
@@ -118,6 +163,14 @@ extern "C" {
 #define FLATCC_JSON_PARSE_GENERIC_MAX_NEST 512
 #endif
 
+/*
+ * Numeric vectors are extended by this many elements at a time while
+ * parsing a run of numbers, and truncated when the run ends.
+ */
+#ifndef FLATCC_JSON_PARSE_VECTOR_CHUNK
+#define FLATCC_JSON_PARSE_VECTOR_CHUNK 64
+#endif
+
 /* Store value even if it is default. */
 #ifndef FLATCC_JSON_PARSE_FORCE_DEFAULTS
 #define FLATCC_JSON_PARSE_FORCE_DEFAULTS 0
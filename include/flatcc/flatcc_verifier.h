@@ -52,6 +52,20 @@ extern "C" {
  */
 
 #include "flatcc/flatcc_types.h"
+#include "flatcc/flatcc_flatbuffers.h"
+
+/*
+ * Generated table verifiers call inline versions of the scalar, struct
+ * and vector field verifiers with the schema's sizes and alignments as
+ * constants, so the compiler can fold away checks such as alignment of
+ * single byte fields, or vector length overflow of byte vectors. Any
+ * failing check calls the runtime verifier to produce the actual
+ * error, so behavior is the same either way. Set to 0 to always call
+ * the runtime verifier, for smaller code.
+ */
+#ifndef FLATCC_VERIFIER_INLINE
+#define FLATCC_VERIFIER_INLINE 1
+#endif
 
 #define FLATCC_VERIFY_ERROR_MAP(XX)\
     XX(ok, "ok")\
@@ -91,7 +105,9 @@ extern "C" {
     XX(union_vector_length_mismatch, "union type and table vectors have different lengths")\
     XX(union_vector_verification_not_supported, "union vector verification not supported")\
     XX(runtime_buffer_size_less_than_size_field, "runtime buffer size less than buffer headers size field")\
-    XX(not_supported, "not supported")
+    XX(not_supported, "not supported")\
+    XX(buffer_incomplete, "buffer incomplete")\
+    XX(runtime_visited_set_missing, "runtime: visited set missing")
 
 
 
@@ -118,6 +134,11 @@ const char *flatcc_verify_error_string(int err);
  * table field, union or table vector is encountered.
  */
 typedef struct flatcc_table_verifier_descriptor flatcc_table_verifier_descriptor_t;
+
+typedef struct flatcc_verify_visited flatcc_verify_visited_t;
+
+typedef struct flatcc_verify_diagnostics flatcc_verify_diagnostics_t;
+
 struct flatcc_table_verifier_descriptor {
     /* Pointer to buffer. Not assumed to be aligned beyond uoffset_t. */
     const void *buf;
@@ -133,6 +154,10 @@ struct flatcc_table_verifier_descriptor {
     flatbuffers_voffset_t tsize;
     /* Size of vtable in bytes. */
     flatbuffers_voffset_t vsize;
+    /* Optional set of already verified tables, or null. */
+    flatcc_verify_visited_t *visited;
+    /* Optional failure report, or null. */
+    flatcc_verify_diagnostics_t *diag;
 };
 
 typedef int flatcc_table_verifier_f(flatcc_table_verifier_descriptor_t *td);
@@ -152,10 +177,75 @@ struct flatcc_union_verifier_descriptor {
     flatbuffers_uoffset_t base;
     /* Offset of union value relative to base. */
     flatbuffers_uoffset_t offset;
+    /* Optional set of already verified tables, or null. */
+    flatcc_verify_visited_t *visited;
+    /* Optional failure report, or null. */
+    flatcc_verify_diagnostics_t *diag;
 };
 
 typedef int flatcc_union_verifier_f(flatcc_union_verifier_descriptor_t *ud);
 
+/*
+ * Optional shared subtree detection.
+ *
+ * Buffers created with a refmap, for example by cloning, can
+ * legitimately share tables between multiple references. The verifier
+ * otherwise visits a shared table once per reference which is only
+ * bounded by the max nesting level, so a malicious buffer can make
+ * verification exponentially slow with only a few kilobytes of data.
+ *
+ * A visited set records each table that has been fully verified so
+ * later references to the same table are not verified again. A table
+ * is identified by its address and its table verifier function: the
+ * same location may be referenced as different table types and must
+ * then be verified once per type. The remaining nesting level is also
+ * recorded and a table is verified again when reached at a deeper
+ * level so the max nesting level is enforced exactly as without a
+ * visited set. Likewise the buffer bounds are recorded, and a table is
+ * verified again when reached from a nested buffer that does not cover
+ * the bounds it was verified within, so a nested buffer is still
+ * verified as self-contained.
+ *
+ * The set is an open addressing hash table stored in caller provided
+ * memory. `buckets` must be a power of 2 and `items` must be zeroed.
+ * No memory is allocated: when the table reaches its load factor, new
+ * tables are verified as usual without being recorded, so a too small
+ * set only reduces the benefit. A table takes at least 4 bytes so
+ * `bufsiz / 4` items can always hold every table in a buffer, but far
+ * fewer are needed in practice.
+ *
+ * The same set may be reused for several buffers only after `reset`.
+ */
+struct flatcc_verify_visited_item {
+    const void *table;
+    flatcc_table_verifier_f *tvf;
+    /* Bounds of the buffer the table was verified within. */
+    const void *buf;
+    const void *end;
+    int ttl;
+};
+
+struct flatcc_verify_visited {
+    size_t count;
+    size_t buckets;
+    struct flatcc_verify_visited_item *items;
+    /* Used when verifying a partially received buffer. */
+    int partial;
+    size_t deferred;
+};
+
+static inline void flatcc_verify_visited_init(flatcc_verify_visited_t *visited,
+        struct flatcc_verify_visited_item *items, size_t buckets)
+{
+    visited->count = 0;
+    visited->buckets = buckets;
+    visited->items = items;
+    visited->partial = 0;
+    visited->deferred = 0;
+}
+
+void flatcc_verify_visited_reset(flatcc_verify_visited_t *visited);
+
 /*
  * The `as_root` functions are normally the only functions called
  * explicitly in this interface.
@@ -193,6 +283,87 @@ int flatcc_verify_table_as_typed_root(const void *buf, size_t bufsiz, flatbuffer
 int flatcc_verify_table_as_typed_root_with_size(const void *buf, size_t bufsiz, flatbuffers_thash_t thash,
         flatcc_table_verifier_f *root_tvf);
 
+/*
+ * Optional diagnostics for rejected buffers.
+ *
+ * The verifier normally only returns an error code. The diagnostics
+ * struct additionally reports where verification failed: `offset` is
+ * the byte offset of the failing field relative to the start of the
+ * root buffer, or 0 if the buffer header failed, and `path` lists the
+ * tables leading to the failure with their field ids, innermost table
+ * first. `depth` is the full length of the path which may exceed the
+ * stored path. Type names are the C names from the generated code.
+ *
+ * The struct is only updated on the failure path, so successful
+ * verification is as fast as without diagnostics. Table vector element
+ * indices and union types are not recorded, only the table field
+ * holding them.
+ */
+#ifndef FLATCC_VERIFY_DIAGNOSTICS_MAX_PATH
+#define FLATCC_VERIFY_DIAGNOSTICS_MAX_PATH 16
+#endif
+
+struct flatcc_verify_diagnostics {
+    int error;
+    size_t offset;
+    int depth;
+    struct {
+        const char *type_name;
+        flatbuffers_voffset_t id;
+    } path[FLATCC_VERIFY_DIAGNOSTICS_MAX_PATH];
+    /* Root buffer, for internal use. */
+    const void *buf;
+};
+
+int flatcc_verify_table_as_root_with_diagnostics(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_diagnostics_t *diag);
+
+int flatcc_verify_table_as_root_with_size_and_diagnostics(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_diagnostics_t *diag);
+
+/*
+ * Same as `flatcc_verify_table_as_root` but skips tables already
+ * recorded in the `visited` set. See `flatcc_verify_visited_t`.
+ */
+int flatcc_verify_table_as_root_with_visited(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_visited_t *visited);
+
+int flatcc_verify_table_as_root_with_size_and_visited(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_visited_t *visited);
+
+/*
+ * Incremental verification of a size prefixed buffer that is still
+ * being received, for example from a socket, so verification can
+ * overlap I/O.
+ *
+ * `buf` is the start of the buffer including the size prefix and
+ * `bufsiz` is the number of bytes received so far. The buffer memory
+ * must stay in place while more data is appended. Returns
+ * `flatcc_verify_error_buffer_incomplete` when the buffer is valid as
+ * far as the received data goes but more is needed, `flatcc_verify_ok`
+ * when everything reachable from the root has been received and
+ * verified, which is normally the entire buffer, or any other
+ * error as soon as it can be detected in the received data.
+ *
+ * Each call walks the buffer from the root, but subtrees that were
+ * completely received and verified in an earlier call are recorded in
+ * `visited` and skipped, so the same visited set must be passed until
+ * verification completes. References beyond the received data are
+ * skipped until the next call while their siblings are still verified.
+ * A larger visited set therefore avoids more repeated work.
+ * Buffers are built back to front such that the root table comes
+ * first, so a buffer is typically verified from the leaves inwards
+ * as data arrives.
+ *
+ * `visited` is required, otherwise
+ * `flatcc_verify_error_runtime_visited_set_missing` is returned.
+ *
+ * Buffers without a size prefix cannot be verified incrementally
+ * because there is no way to tell when all data has been received.
+ */
+int flatcc_verify_table_as_root_with_size_partial(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_visited_t *visited);
+
 /*
  * The buffer header is verified by any of the `_as_root` verifiers, but
  * this function may be used as a quick sanity check.
@@ -216,6 +387,13 @@ int flatcc_verify_typed_buffer_header_with_size(const void *buf, size_t *bufsiz,
  * verifier function.
  */
 
+/*
+ * Called by a table verifier when field `id` fails with `err`. Records
+ * the failure in the diagnostics, if any, and returns `err`.
+ */
+int flatcc_verify_table_error(flatcc_table_verifier_descriptor_t *td, int err,
+        flatbuffers_voffset_t id, const char *type_name);
+
 /* Scalar, enum or struct field. */
 int flatcc_verify_field(flatcc_table_verifier_descriptor_t *td,
         flatbuffers_voffset_t id, size_t size, uint16_t align);
@@ -238,6 +416,65 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
         flatbuffers_voffset_t id, int required, const char *fid,
         uint16_t align, flatcc_table_verifier_f tvf);
 
+/*
+ * Same as `flatcc_verify_field` and `flatcc_verify_vector_field`, but
+ * expected to be called with constant `size`, `elem_size`, `align`
+ * and `max_count` so a large part of the checks is resolved at compile
+ * time. The checks mirror the runtime verifier and may be stricter,
+ * for example on misaligned empty vectors, but never more permissive:
+ * on failure the runtime verifier decides.
+ */
+static inline int flatcc_verify_field_inline(flatcc_table_verifier_descriptor_t *td,
+        flatbuffers_voffset_t id, size_t size, uint16_t align)
+{
+#if FLATCC_VERIFIER_INLINE
+    flatbuffers_voffset_t vo = (flatbuffers_voffset_t)((id + 2u) * sizeof(flatbuffers_voffset_t));
+    flatbuffers_uoffset_t k;
+
+    if (vo >= td->vsize) {
+        return flatcc_verify_ok;
+    }
+    k = __flatbuffers_voffset_read_from_pe((const uint8_t *)td->vtable + vo);
+    if (k == 0) {
+        return flatcc_verify_ok;
+    }
+    if (k + size <= td->tsize && (k + size >= k || sizeof(flatbuffers_uoffset_t) > sizeof(flatbuffers_voffset_t))
+            && !((k + td->table + (flatbuffers_uoffset_t)(size_t)td->buf) & (align - 1u))) {
+        return flatcc_verify_ok;
+    }
+#endif
+    return flatcc_verify_field(td, id, size, align);
+}
+
+static inline int flatcc_verify_vector_field_inline(flatcc_table_verifier_descriptor_t *td,
+        flatbuffers_voffset_t id, int required, size_t elem_size, uint16_t align, size_t max_count)
+{
+#if FLATCC_VERIFIER_INLINE
+    const size_t offset_size = sizeof(flatbuffers_uoffset_t);
+    flatbuffers_voffset_t vo = (flatbuffers_voffset_t)((id + 2u) * sizeof(flatbuffers_voffset_t));
+    flatbuffers_uoffset_t k, base, n;
+
+    k = vo < td->vsize ? __flatbuffers_voffset_read_from_pe((const uint8_t *)td->vtable + vo) : 0;
+    if (k == 0) {
+        if (!required) {
+            return flatcc_verify_ok;
+        }
+    } else if (k + offset_size <= td->tsize && !((k += td->table) & (offset_size - 1u))) {
+        base = k + __flatbuffers_uoffset_read_from_pe((const uint8_t *)td->buf + k);
+        /* Vector header. */
+        if (base > k && base + offset_size > base && base + offset_size <= td->end && !(base & (offset_size - 1u))) {
+            n = __flatbuffers_uoffset_read_from_pe((const uint8_t *)td->buf + base);
+            base += (flatbuffers_uoffset_t)offset_size;
+            if (!(base & ((align - 1u) | (offset_size - 1u))) && n <= max_count
+                    && td->end - base >= n * elem_size) {
+                return flatcc_verify_ok;
+            }
+        }
+    }
+#endif
+    return flatcc_verify_vector_field(td, id, required, elem_size, align, max_count);
+}
+
 /*
  * A NONE type will not accept a table being present, and a required
  * union will not accept a type field being absent, and an absent type
@@ -12,6 +12,25 @@ extern "C" {
 #include <stdint.h>
 #endif
 
+/*
+ * Whole blocks are encoded and decoded 24 source bytes or 32 source
+ * symbols at a time with AVX2 when targeted, or when the CPU supports
+ * it on GCC and Clang, see psimd.h. Partial blocks, padding, skipped
+ * space and non-alphabet symbols always take the scalar path, so the
+ * result is the same either way. Define PORTABLE_BASE64_SIMD as 0 to
+ * only use the scalar path.
+ */
+#ifndef PORTABLE_BASE64_SIMD
+#define PORTABLE_BASE64_SIMD 1
+#endif
+
+#if PORTABLE_BASE64_SIMD
+#include "psimd.h"
+#if defined(PORTABLE_AVX2)
+#define PBASE64_AVX2 1
+#endif
+#endif
+
 #define BASE64_EOK    0
 /* 0 or mure full blocks decoded, remaining content may be parsed with fresh buffer. */
 #define BASE64_EMORE  1
@@ -149,6 +168,110 @@ static inline size_t base64_decoded_size(size_t len)
     }
 }
 
+#ifdef PBASE64_AVX2
+
+/*
+ * Encodes whole groups of 24 bytes into 32 symbols while at least 28
+ * bytes remain because each 128-bit lane loads 16 bytes for 12.
+ * Returns the number of bytes encoded.
+ *
+ * The bytes of each 3 byte group are spread over a 32-bit word and
+ * shifted into four 6-bit indices by multiplies. The indices are mapped
+ * to symbols by adding an offset looked up by alphabet range.
+ */
+PORTABLE_TARGET_AVX2
+static inline size_t base64_encode_avx2(uint8_t *dst, const uint8_t *src, size_t len, int url)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    /* Offsets for A-Z, a-z, 0-9 (10 entries), then symbols 62 and 63. */
+    const __m256i offsets = url ? _mm256_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0,
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0) :
+        _mm256_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m256i x, t, i;
+    size_t n = 0;
+
+    while (len - n >= 28) {
+        x = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                _mm_loadu_si128((const __m128i *)(src + n))),
+                _mm_loadu_si128((const __m128i *)(src + n + 12)), 1);
+        x = _mm256_shuffle_epi8(x, shuffle);
+        t = _mm256_mulhi_epu16(_mm256_and_si256(x, _mm256_set1_epi32(0x0fc0fc00)),
+                _mm256_set1_epi32(0x04000040));
+        x = _mm256_mullo_epi16(_mm256_and_si256(x, _mm256_set1_epi32(0x003f03f0)),
+                _mm256_set1_epi32(0x01000010));
+        x = _mm256_or_si256(x, t);
+        /* 0..25 -> 0, 26..51 -> 1, 52..61 -> 2..11, 62 -> 12, 63 -> 13. */
+        i = _mm256_subs_epu8(x, _mm256_set1_epi8(51));
+        i = _mm256_sub_epi8(i, _mm256_cmpgt_epi8(x, _mm256_set1_epi8(25)));
+        x = _mm256_add_epi8(x, _mm256_shuffle_epi8(offsets, i));
+        _mm256_storeu_si256((__m256i *)dst, x);
+        dst += 32;
+        n += 24;
+    }
+    return n;
+}
+
+/*
+ * Decodes whole groups of 32 alphabet symbols into 24 bytes. Stops at
+ * a group holding any other symbol, including padding and space, when
+ * less than 32 symbols remain, or when less than 24 bytes of output
+ * remain. Returns the number of symbols decoded.
+ */
+PORTABLE_TARGET_AVX2
+static inline size_t base64_decode_avx2(uint8_t *dst, const uint8_t *src, size_t len, size_t limit, int url)
+{
+    const __m256i c62 = _mm256_set1_epi8(url ? '-' : '+');
+    const __m256i c63 = _mm256_set1_epi8(url ? '_' : '/');
+    const __m256i d62 = _mm256_set1_epi8(url ? 62 - '-' : 62 - '+');
+    const __m256i d63 = _mm256_set1_epi8(url ? 63 - '_' : 63 - '/');
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    __m256i x, upper, lower, digit, e62, e63, d;
+    size_t n = 0;
+
+    while (len - n >= 32 && limit >= 24) {
+        x = _mm256_loadu_si256((const __m256i *)(src + n));
+        /* Signed compares, so bytes above 0x7f are in no range. */
+        upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+        lower = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('a' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), x));
+        digit = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('0' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), x));
+        e62 = _mm256_cmpeq_epi8(x, c62);
+        e63 = _mm256_cmpeq_epi8(x, c63);
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(upper, lower),
+                _mm256_or_si256(digit, _mm256_or_si256(e62, e63)))) != UINT32_C(0xffffffff)) {
+            break;
+        }
+        d = _mm256_or_si256(
+                _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                    _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+                _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+                    _mm256_or_si256(_mm256_and_si256(e62, d62), _mm256_and_si256(e63, d63))));
+        x = _mm256_add_epi8(x, d);
+        /* Merge 4 6-bit values into 24 bits per 32-bit word, then pack the bytes. */
+        x = _mm256_maddubs_epi16(x, _mm256_set1_epi32(0x01400140));
+        x = _mm256_madd_epi16(x, _mm256_set1_epi32(0x00011000));
+        x = _mm256_shuffle_epi8(x, shuffle);
+        x = _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(x));
+        _mm_storel_epi64((__m128i *)(dst + 16), _mm256_extracti128_si256(x, 1));
+        dst += 24;
+        limit -= 24;
+        n += 32;
+    }
+    return n;
+}
+
+#endif /* PBASE64_AVX2 */
+
 static inline int base64_encode(uint8_t *dst, const uint8_t *src, size_t *dst_len, size_t *src_len, int mode)
 {
     const uint8_t *rfc4648_alphabet            = (const uint8_t *)
@@ -182,6 +305,15 @@ static inline int base64_encode(uint8_t *dst, const uint8_t *src, size_t *dst_le
 
     ret = BASE64_EOK;
 
+#ifdef PBASE64_AVX2
+    if (len >= 28 && portable_cpu_has_avx2()) {
+        size_t n = base64_encode_avx2(dst, src, len, mode == base64_mode_url);
+
+        len -= n;
+        src += n;
+        dst += n / 3 * 4;
+    }
+#endif
     /* Encodes 4 destination bytes from 3 source bytes. */
     while (len >= 3) {
         dst[0] = T[((src[0] >> 2))];
@@ -331,6 +463,11 @@ static inline int base64_decode(uint8_t *dst, const uint8_t *src, size_t *dst_le
     size_t len = (size_t)-1, mark;
     const uint8_t *T = base64rfc4648_decode;
     int skipspace = mode & base64_dec_modifier_skipspace;
+#ifdef PBASE64_AVX2
+    /* Without a source length the input may end before a whole group. */
+    int simd = src_len && portable_cpu_has_avx2();
+    const uint8_t *retry = src;
+#endif
 
     if (src_len) {
         len = *src_len;
@@ -353,6 +490,21 @@ static inline int base64_decode(uint8_t *dst, const uint8_t *src, size_t *dst_le
         limit = *dst_len;
     }
     while(limit > 0) {
+#ifdef PBASE64_AVX2
+        /* After a group the kernel rejects, continue with scalar until past it. */
+        if (simd && src >= retry && len >= 32 && limit >= 24) {
+            k = base64_decode_avx2(dst, src, len, limit, mode == base64_mode_url);
+            src += k;
+            len -= k;
+            dst += k / 4 * 3;
+            limit -= k / 4 * 3;
+            mark = len;
+            retry = src + 32;
+            if (k) {
+                continue;
+            }
+        }
+#endif
         for (i = 0; i < 4; ++i) {
             if (len == i) {
                 k = i;
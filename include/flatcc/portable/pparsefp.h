@@ -111,9 +111,155 @@ static inline int parse_float_is_range_error(float x)
 #include "grisu3_parse.h"
 #endif
 
+/*
+ * The fast path handles plain decimal numbers with at most 19
+ * significant digits and leaves anything else to grisu3 or strtod.
+ */
+#ifndef PORTABLE_USE_EISEL_LEMIRE
+#define PORTABLE_USE_EISEL_LEMIRE 1
+#endif
+
+#if PORTABLE_USE_EISEL_LEMIRE
+#include <float.h>
+#include "pparseint.h"
+#include "eisel_lemire_parse.h"
+
+/*
+ * Returns end of number and stores the correctly rounded value if the
+ * number is a plain decimal number that can be converted without
+ * ambiguity, otherwise returns null and leaves `result` unmodified.
+ *
+ * Only reads buf[0] through buf[len - 1] and returns null if the number
+ * runs to the end of the buffer, or if it has leading zeroes, a hex
+ * prefix, or a form grisu3_parse_double would reject, so the slow path
+ * can handle these exactly as before.
+ */
+static inline const char *parse_double_fast(const char *buf, size_t len, double *result)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static const uint64_t pow10_u64[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
+    const char *end = buf + len, *k;
+    uint64_t w = 0, v;
+    int sign, n, digits = 0, q = 0, e = 0, esign;
+
+    if (buf == end) {
+        return 0;
+    }
+    sign = *buf == '-';
+    buf += sign;
+    if (buf == end || *buf < '0' || *buf > '9') {
+        return 0;
+    }
+    if (*buf == '0') {
+        ++buf;
+        if (buf == end || (*buf >= '0' && *buf <= '9') || (*buf | 0x20) == 'x') {
+            return 0;
+        }
+    } else {
+        k = buf;
+        while (end - buf >= 8 && (n = parse_integer_digits8(buf, &v))) {
+            w = w * pow10_u64[n] + v;
+            buf += n;
+            if (n < 8) {
+                break;
+            }
+        }
+        while (buf != end && *buf >= '0' && *buf <= '9') {
+            w = w * 10 + (uint64_t)(*buf++ - '0');
+        }
+        digits = (int)(buf - k);
+    }
+    if (buf != end && *buf == '.') {
+        ++buf;
+        k = buf;
+        if (w == 0) {
+            /* Zeroes after the decimal point are not significant. */
+            while (buf != end && *buf == '0') {
+                ++buf;
+            }
+            q -= (int)(buf - k);
+            k = buf;
+        }
+        while (end - buf >= 8 && (n = parse_integer_digits8(buf, &v))) {
+            w = w * pow10_u64[n] + v;
+            buf += n;
+            if (n < 8) {
+                break;
+            }
+        }
+        while (buf != end && *buf >= '0' && *buf <= '9') {
+            w = w * 10 + (uint64_t)(*buf++ - '0');
+        }
+        if (buf == k && q == 0) {
+            /* No digits after the decimal point. */
+            return 0;
+        }
+        digits += (int)(buf - k);
+        q -= (int)(buf - k);
+    }
+    if (digits > 19) {
+        return 0;
+    }
+    if (buf != end && (*buf | 0x20) == 'e') {
+        ++buf;
+        esign = 0;
+        if (buf != end && (*buf == '+' || *buf == '-')) {
+            esign = *buf++ == '-';
+        }
+        k = buf;
+        while (buf != end && *buf >= '0' && *buf <= '9') {
+            if (e < 10000) {
+                e = e * 10 + *buf - '0';
+            }
+            ++buf;
+        }
+        if (buf == k) {
+            return 0;
+        }
+        q += esign ? -e : e;
+    }
+    if (buf == end) {
+        return 0;
+    }
+    if (w == 0) {
+        *result = sign ? -0.0 : 0.0;
+        return buf;
+    }
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    /*
+     * Both w and the power of ten are exact doubles, so a single
+     * multiplication or division is correctly rounded.
+     */
+    if (w <= ((uint64_t)1 << 53) && q >= -22 && q <= 22) {
+        double d = (double)w;
+
+        d = q < 0 ? d / pow10[-q] : d * pow10[q];
+        *result = sign ? -d : d;
+        return buf;
+    }
+#endif
+    if (eisel_lemire_encode_double(w, q, sign, result)) {
+        return buf;
+    }
+    return 0;
+}
+#endif
+
 #ifdef grisu3_parse_double_is_defined
 static inline const char *parse_double(const char *buf, size_t len, double *result)
 {
+#if PORTABLE_USE_EISEL_LEMIRE
+    const char *end = parse_double_fast(buf, len, result);
+
+    if (end) {
+        return end;
+    }
+#endif
     return grisu3_parse_double(buf, len, result);
 }
 #else
@@ -122,6 +268,13 @@ static inline const char *parse_double(const char *buf, size_t len, double *resu
 {
     char *end;
 
+#if PORTABLE_USE_EISEL_LEMIRE
+    const char *fast_end = parse_double_fast(buf, len, result);
+
+    if (fast_end) {
+        return fast_end;
+    }
+#endif
     (void)len;
     *result = strtod(buf, &end);
     return end;
@@ -52,6 +52,9 @@ extern "C" {
 #ifndef UINT8_MAX
 #include <stdint.h>
 #endif
+#include <string.h> /* memcpy */
+
+#include "pendian.h"
 
 #define PARSE_INTEGER_UNSIGNED       0
 #define PARSE_INTEGER_SIGNED         1
@@ -61,6 +64,53 @@ extern "C" {
 #define PARSE_INTEGER_UNMATCHED     -4
 #define PARSE_INTEGER_END           -5
 
+/*
+ * Converts up to 8 leading decimal digits at once using SWAR (SIMD
+ * within a register) arithmetic. Always reads 8 bytes from `buf`,
+ * which must be accessible, and returns the number of leading digits
+ * (0..8). Unless the count is zero, the value of the digits is stored
+ * in `value`. Digits may be followed by any byte, including a digit
+ * beyond the first 8.
+ */
+static inline int parse_integer_digits8(const char *buf, uint64_t *value)
+{
+    uint64_t x, x7, m;
+    int n;
+
+    memcpy(&x, buf, sizeof(x));
+    x = le64toh(x);
+    /*
+     * The high bit of each byte in `m` is set unless the byte is in
+     * '0'..'9'. Masking to 7 bits first prevents carries between bytes.
+     */
+    x7 = x & 0x7f7f7f7f7f7f7f7fULL;
+    m = ~((x7 + 0x5050505050505050ULL) & ~(x7 + 0x4646464646464646ULL) & ~x);
+    m &= 0x8080808080808080ULL;
+    if (m == 0) {
+        n = 8;
+    } else {
+#if defined(__GNUC__) || defined(__clang__)
+        n = __builtin_ctzll(m) >> 3;
+#else
+        n = 0;
+        while (!(m & 0x80)) {
+            m >>= 8;
+            ++n;
+        }
+#endif
+        if (n == 0) {
+            return 0;
+        }
+        /* First digit moves to the most significant position, zeroes lead. */
+        x <<= 64 - 8 * n;
+    }
+    x = ((x & 0x0f0f0f0f0f0f0f0fULL) * 2561) >> 8;
+    x = ((x & 0x00ff00ff00ff00ffULL) * 6553601) >> 16;
+    x = ((x & 0x0000ffff0000ffffULL) * 42949672960001ULL) >> 32;
+    *value = x & 0xffffffff;
+    return n;
+}
+
 /*
  * Generic integer parser that holds 64-bit unsigned values and stores
  * sign separately. Leading space is not valid.
@@ -76,9 +126,12 @@ extern "C" {
  */
 static const char *parse_integer(const char *buf, size_t len, uint64_t *value, int *status)
 {
+    static const uint64_t pow10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
     uint64_t x0, x = 0;
     const char *k, *end = buf + len;
-    int sign, status_;
+    int sign, n, status_;
 
     if (!status) {
         status = &status_;
@@ -90,13 +143,24 @@ static const char *parse_integer(const char *buf, size_t len, uint64_t *value, i
     k = buf;
     sign = *buf == '-';
     buf += sign;
+    /* Any 19 digit value fits, so only the remaining digits need overflow checks. */
+    while (end - buf >= 8 && buf - k - sign <= 11) {
+        if (!(n = parse_integer_digits8(buf, &x0))) {
+            break;
+        }
+        x = x * pow10[n] + x0;
+        buf += n;
+        if (n < 8) {
+            break;
+        }
+    }
     while (buf != end && *buf >= '0' && *buf <= '9') {
-        x0 = x;
-        x = x * 10 + (uint64_t)(*buf - '0');
-        if (x0 > x) {
+        x0 = (uint64_t)(*buf - '0');
+        if (x > UINT64_MAX / 10 || (x == UINT64_MAX / 10 && x0 > UINT64_MAX % 10)) {
             *status = sign ? PARSE_INTEGER_UNDERFLOW : PARSE_INTEGER_OVERFLOW;
             return 0;
         }
+        x = x * 10 + x0;
         ++buf;
     }
     if (buf == k) {
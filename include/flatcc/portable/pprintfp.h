@@ -12,12 +12,26 @@ extern "C" {
 #define PORTABLE_USE_GRISU3 1
 #endif
 
+/*
+ * Shortest round-trip printing using the Schubfach algorithm. Takes
+ * precedence over grisu3 which falls back to sprintf in rare cases and
+ * prints floats with the digits of the float widened to double.
+ */
+#ifndef PORTABLE_USE_SCHUBFACH
+#define PORTABLE_USE_SCHUBFACH 1
+#endif
+
 
-#if PORTABLE_USE_GRISU3
+#if PORTABLE_USE_SCHUBFACH
+#include "schubfach_print.h"
+#elif PORTABLE_USE_GRISU3
 #include "grisu3_print.h"
 #endif
 
-#ifdef grisu3_print_double_is_defined
+#if defined(schubfach_print_double_is_defined)
+#define print_float(n, p) schubfach_print_float((float)(n), (p))
+#define print_double(n, p) schubfach_print_double((double)(n), (p))
+#elif defined(grisu3_print_double_is_defined)
 /* Currently there is not special support for floats. */
 #define print_float(n, p) grisu3_print_double((float)(n), (p))
 #define print_double(n, p) grisu3_print_double((double)(n), (p))
@@ -36,7 +36,10 @@
  * non-zero integers, and "false\0" otherwise.
  *
  * The general algorithm is in-place formatting using binary search log10
- * followed by duff device loop unrolling div / 100 stages.
+ * followed by duff device loop unrolling div / 100 stages. When the
+ * compiler has a count leading zeroes builtin, 64-bit numbers instead
+ * find the number of digits without branches and print the low digits 8
+ * at a time, see `PPRINTINT_BRANCHLESS`.
  *
  * The simpler post copy algorithm also provided for fmt_(u)int uses a
  * temp buffer and loops over div/100 and post copy to target buffer.
@@ -110,6 +113,46 @@ static int print_long(long n, char *p);
      (((uint8_t*)(p))[1] = ((uint8_t*)(q))[1]))
 #endif
 
+/*
+ * Counts digits of 64-bit numbers from the bit length and a single
+ * comparison with a power of ten rather than a binary search over
+ * powers of ten, so the low digits can be printed in independent
+ * chunks without first branching on the length. This mostly helps long
+ * numbers such as floating point significands. Requires a count
+ * leading zeroes builtin and can be disabled by defining
+ * PPRINTINT_BRANCHLESS 0.
+ */
+#ifndef PPRINTINT_BRANCHLESS
+#if defined(__GNUC__) || defined(__clang__)
+#define PPRINTINT_BRANCHLESS 1
+#else
+#define PPRINTINT_BRANCHLESS 0
+#endif
+#endif
+
+#if PPRINTINT_BRANCHLESS
+
+static const uint64_t __print_pow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+/* 1233 / 4096 approximates log10(2) from below, n | 1 maps 0 to 1. */
+static int __print_count_digits64(uint64_t n)
+{
+    int t;
+
+    n |= 1;
+    t = ((64 - __builtin_clzll(n)) * 1233) >> 12;
+    return t - (n < __print_pow10[t]) + 1;
+}
+
+#endif
+
 static const char __print_digit_pairs[] =
     "0001020304050607080910111213141516171819"
     "2021222324252627282930313233343536373839"
@@ -287,6 +330,59 @@ static int print_uint32(uint32_t n, char *p)
     return k;
 }
 
+#if PPRINTINT_BRANCHLESS
+
+/* Prints exactly 8 digits of n < 10^8 ending before p. */
+#define __print_8_digits(p, n) do {                                         \
+    uint32_t __a = (n) / 10000, __b = (n) % 10000;                          \
+    __print_unaligned_copy_16((p) - 2, __print_digit_pairs + (__b % 100) * 2);\
+    __print_unaligned_copy_16((p) - 4, __print_digit_pairs + (__b / 100) * 2);\
+    __print_unaligned_copy_16((p) - 6, __print_digit_pairs + (__a % 100) * 2);\
+    __print_unaligned_copy_16((p) - 8, __print_digit_pairs + (__a / 100) * 2);\
+} while (0)
+
+/*
+ * With the length known up front, the low digits are printed in
+ * independent chunks of 8 using 32-bit division, leaving at most 8
+ * leading digits to the usual stages.
+ */
+static int print_uint64(uint64_t n, char *p)
+{
+    int k;
+    uint32_t m;
+
+    k = __print_count_digits64(n);
+    if (k < 10) {
+        return print_uint32((uint32_t)n, p);
+    }
+    p += k;
+    *p = '\0';
+    m = (uint32_t)(n % 100000000);
+    n /= 100000000;
+    __print_8_digits(p, m);
+    p -= 8;
+    if (k > 16) {
+        m = (uint32_t)(n % 100000000);
+        n /= 100000000;
+        __print_8_digits(p, m);
+        p -= 8;
+    }
+    m = (uint32_t)n;
+    while (m >= 100) {
+        p -= 2;
+        __print_unaligned_copy_16(p, __print_digit_pairs + (m % 100) * 2);
+        m /= 100;
+    }
+    if (m >= 10) {
+        __print_unaligned_copy_16(p - 2, __print_digit_pairs + m * 2);
+    } else {
+        p[-1] = (char)m + '0';
+    }
+    return k;
+}
+
+#else
+
 static int print_uint64(uint64_t n, char *p)
 {
     int k = 0;
@@ -379,6 +475,8 @@ static int print_uint64(uint64_t n, char *p)
     return k;
 }
 
+#endif /* PPRINTINT_BRANCHLESS */
+
 static int print_int8(int8_t n, char *p)
 {
     int sign;
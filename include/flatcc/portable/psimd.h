@@ -0,0 +1,189 @@
+#ifndef PSIMD_H
+#define PSIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Guarded to allow inclusion of pstdint.h first, if stdint.h is not supported. */
+#ifndef UINT8_MAX
+#include <stdint.h>
+#endif
+
+/*
+ * Minimal x86 SIMD detection for byte classification kernels.
+ *
+ * `PORTABLE_SSE2` is defined when SSE2 intrinsics can be used
+ * unconditionally, which is always the case on x86-64.
+ *
+ * `PORTABLE_AVX2` is defined when AVX2 kernels can be compiled. When
+ * the compiler already targets AVX2 (e.g. -mavx2 or -march=native),
+ * `PORTABLE_TARGET_AVX2` is empty and `portable_cpu_has_avx2()` is 1.
+ * Otherwise, on GCC and Clang, kernels are compiled with a function
+ * target attribute and `portable_cpu_has_avx2()` checks the CPU at
+ * runtime. Callers must only call `PORTABLE_TARGET_AVX2` functions
+ * when `portable_cpu_has_avx2()` is true.
+ *
+ * `portable_ctz32` and `portable_ctz64` count trailing zeroes of a
+ * non-zero mask as returned by `_mm_movemask_epi8` and similar.
+ *
+ * `portable_sse2_string_run(p, end)` returns the first byte that ends
+ * JSON string content: '"', '\\', or a control character < 0x20. It
+ * stops early when less than 16 bytes remain and leaves the tail to the
+ * caller, so the result is either a match or a position within 16 bytes
+ * of `end`. `portable_avx2_string_run` is the same with AVX2 blocks.
+ * The JSON parser uses it to skip string content and the JSON printer
+ * to find bytes that must be escaped.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PORTABLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(PORTABLE_SSE2) && defined(__AVX2__)
+#define PORTABLE_AVX2 1
+#define PORTABLE_TARGET_AVX2
+#define portable_cpu_has_avx2() 1
+#include <immintrin.h>
+#elif defined(PORTABLE_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__clang__) && __clang_major__ >= 4) || \
+    (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define PORTABLE_AVX2 1
+#define PORTABLE_AVX2_DISPATCH 1
+#define PORTABLE_TARGET_AVX2 __attribute__((target("avx2")))
+#define portable_cpu_has_avx2() __builtin_cpu_supports("avx2")
+#include <immintrin.h>
+#endif
+
+#if defined(PORTABLE_SSE2)
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define portable_ctz32(x) ((unsigned)__builtin_ctz(x))
+#define portable_ctz64(x) ((unsigned)__builtin_ctzll(x))
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+
+static __inline unsigned portable_ctz32(unsigned long x)
+{
+    unsigned long i;
+
+    _BitScanForward(&i, x);
+    return (unsigned)i;
+}
+
+static __inline unsigned portable_ctz64(unsigned __int64 x)
+{
+    unsigned long i;
+
+    if ((unsigned long)x) {
+        _BitScanForward(&i, (unsigned long)x);
+        return (unsigned)i;
+    }
+    _BitScanForward(&i, (unsigned long)(x >> 32));
+    return (unsigned)i + 32;
+}
+
+#else
+
+/* Unknown compiler with SSE2, don't risk it. */
+#undef PORTABLE_SSE2
+#undef PORTABLE_AVX2
+
+#endif
+
+#endif /* PORTABLE_SSE2 */
+
+#if defined(PORTABLE_SSE2)
+
+/* 0xff for each byte < 0x20, otherwise 0. */
+static inline __m128i portable_sse2_control_bytes(__m128i x)
+{
+    return _mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f));
+}
+
+static inline uint32_t portable_sse2_string_mask(__m128i x)
+{
+    __m128i q = _mm_cmpeq_epi8(x, _mm_set1_epi8('\"'));
+    __m128i e = _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'));
+
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(q, e),
+            portable_sse2_control_bytes(x)));
+}
+
+static inline const char *portable_sse2_string_run(const char *p, const char *end)
+{
+    uint32_t m;
+
+    while (end - p >= 32) {
+        m = portable_sse2_string_mask(_mm_loadu_si128((const __m128i *)p)) |
+            (portable_sse2_string_mask(_mm_loadu_si128((const __m128i *)(p + 16))) << 16);
+        if (m) {
+            return p + portable_ctz32(m);
+        }
+        p += 32;
+    }
+    if (end - p >= 16) {
+        m = portable_sse2_string_mask(_mm_loadu_si128((const __m128i *)p));
+        if (m) {
+            return p + portable_ctz32(m);
+        }
+        p += 16;
+    }
+    return p;
+}
+
+#endif /* PORTABLE_SSE2 */
+
+#if defined(PORTABLE_AVX2)
+
+PORTABLE_TARGET_AVX2
+static inline __m256i portable_avx2_control_bytes(__m256i x)
+{
+    return _mm256_cmpeq_epi8(_mm256_max_epu8(x, _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f));
+}
+
+PORTABLE_TARGET_AVX2
+static inline uint32_t portable_avx2_string_mask(__m256i x)
+{
+    __m256i q = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\"'));
+    __m256i e = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'));
+
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(q, e),
+            portable_avx2_control_bytes(x)));
+}
+
+PORTABLE_TARGET_AVX2
+static inline const char *portable_avx2_string_run(const char *p, const char *end)
+{
+    uint64_t m;
+
+    while (end - p >= 64) {
+        m = (uint64_t)portable_avx2_string_mask(_mm256_loadu_si256((const __m256i *)p)) |
+            ((uint64_t)portable_avx2_string_mask(_mm256_loadu_si256((const __m256i *)(p + 32))) << 32);
+        if (m) {
+            return p + portable_ctz64(m);
+        }
+        p += 64;
+    }
+    if (end - p >= 32) {
+        m = portable_avx2_string_mask(_mm256_loadu_si256((const __m256i *)p));
+        if (m) {
+            return p + portable_ctz64(m);
+        }
+        p += 32;
+    }
+    return portable_sse2_string_run(p, end);
+}
+
+#endif /* PORTABLE_AVX2 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PSIMD_H */
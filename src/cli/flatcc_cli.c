@@ -38,7 +38,9 @@ void usage(FILE *fp)
 #endif
             "  --verifier                 Generate verifier for schema\n"
             "  --json-parser              Generate json parser for schema\n"
+            "  --json-parser-hash         Like --json-parser, but match names by perfect hash\n"
             "  --json-printer             Generate json printer for schema\n"
+            "  --json-printer-table       Like --json-printer, but table driven\n"
             "  --json                     Generate both json parser and printer for schema\n"
             "  --version                  Show version\n"
             "  -h | --help                Help message\n"
@@ -111,9 +113,19 @@ void help(FILE *fp)
         "the schema. It depends on some flatcc headers and the runtime library but\n"
         "not on other generated files except other parsers from included schema.\n"
         "\n"
+        "--json-parser-hash generates the json parser with field names and enum\n"
+        "symbols matched by a perfect hash and a single compare instead of a trie\n"
+        "of 8 byte word compares. This can be faster for wide tables and large enums\n"
+        "with long shared name prefixes. It may be combined with --json.\n"
+        "\n"
         "--json-printer generates a file that implements json printers for the schema\n"
         "and has dependencies similar to --json-parser.\n"
         "\n"
+        "--json-printer-table generates the json printer with a static table of\n"
+        "field descriptors per table walked by a runtime loop instead of a call\n"
+        "per field. The output is the same with much less machine code for\n"
+        "large schemas. It may be combined with --json.\n"
+        "\n"
         "--json is generates both printer and parser.\n"
         "\n"
 #if FLATCC_REFLECTION
@@ -220,6 +232,16 @@ int set_opt(flatcc_options_t *opts, const char *s, const char *a)
         opts->cgen_json_parser = 1;
         return noarg;
     }
+    if (0 == strcmp("-json-parser-hash", s)) {
+        opts->cgen_json_parser = 1;
+        opts->cgen_json_parser_hash = 1;
+        return noarg;
+    }
+    if (0 == strcmp("-json-printer-table", s)) {
+        opts->cgen_json_printer = 1;
+        opts->cgen_json_printer_table = 1;
+        return noarg;
+    }
     if (0 == strcmp("-json-printer", s)) {
         opts->cgen_json_printer = 1;
         return noarg;
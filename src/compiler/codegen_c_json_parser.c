@@ -559,6 +559,14 @@ repeat_nested:
     }
     if (is_array || is_vector) {
         println(out, "buf = flatcc_json_parser_array_start(ctx, buf, end, &more);");
+        if (is_vector && is_scalar && st != fb_bool && st != fb_char) {
+            /* Leading numbers are added in bulk, the rest one element at a time. */
+            println(out, "buf = flatcc_json_parser_extend_%s_vector(ctx, buf, end, &more);", tname_prefix);
+        }
+        if (is_vector && is_table) {
+            /* Large vectors may be parsed in parallel, otherwise one element at a time. */
+            println(out, "buf = flatcc_json_parser_parallel_tables(ctx, buf, end, &more, %s_parse_json_table);", snref.text);
+        }
         /* Note that we reuse `more` which is safe because it is updated at the end of the main loop. */
         println(out, "while (more) {"); indent();
     }
@@ -654,8 +662,8 @@ repeat_nested:
             println(out, "buf = flatcc_json_parser_union_vector(ctx, buf, end, %"PRIu64", %"PRIu64", h_unions, %s_parse_json_union);",
                 (uint64_t)member->export_index, member->id, snref.text);
         } else {
-            println(out, "buf = flatcc_json_parser_union(ctx, buf, end, %"PRIu64", %"PRIu64", h_unions, %s_parse_json_union);",
-                (uint64_t)member->export_index, member->id, snref.text);
+            println(out, "buf = flatcc_json_parser_union_speculative(ctx, buf, end, %"PRIu64", %"PRIu64", h_unions, %s_parse_json_union, %s_json_union_table_types);",
+                (uint64_t)member->export_index, member->id, snref.text, snref.text);
         }
     } else if (is_union_type) {
         println(out, "static flatcc_json_parser_integral_symbol_f *symbolic_parsers[] = {");
@@ -866,6 +874,10 @@ struct trie {
     int type;
     int union_total;
     int label;
+    /* Perfect hash dispatch, when enabled and found. */
+    int buckets;
+    uint16_t *disp;
+    int *slots;
 };
 
 /*
@@ -1126,6 +1138,206 @@ static void gen_trie(fb_output_t *out, trie_t *trie, int a, int b, int pos)
     }
 }
 
+/*
+ * With `--json-parser-hash` names are matched by a minimal perfect hash
+ * instead of the trie. Names are hashed into buckets of a few names, and
+ * starting with the largest bucket, each bucket is given the first
+ * displacement that moves all of its names into free slots. The
+ * generated parser hashes the name, switches on the slot, and confirms
+ * the name with a single compare. The hash must match
+ * `flatcc_json_parser_symbol_hash/slot` in the runtime. The trie is used
+ * if no displacements are found, which is unlikely.
+ */
+#define PHASH_MULTIPLIER UINT64_C(0x9e3779b97f4a7c15)
+#define PHASH_BUCKET_SIZE 4
+#define PHASH_MAX_DISP 65535
+
+static uint64_t phash_symbol(const char *s, int len)
+{
+    uint64_t h = 0, w;
+    int i, k;
+
+    while (len > 0) {
+        k = len < 8 ? len : 8;
+        for (w = 0, i = 0; i < k; ++i) {
+            w |= ((uint64_t)s[i]) << (56 - i * 8);
+        }
+        h = (h ^ w) * PHASH_MULTIPLIER;
+        s += k;
+        len -= k;
+    }
+    return h ^ (h >> 32);
+}
+
+static int phash_bucket(uint64_t h, int buckets)
+{
+    return (int)(((h & UINT32_MAX) * (uint64_t)buckets) >> 32);
+}
+
+static int phash_slot(uint64_t h, int d, int slots)
+{
+    h ^= ((uint64_t)d + 1) * PHASH_MULTIPLIER;
+    h ^= h >> 29;
+    h *= PHASH_MULTIPLIER;
+    return (int)(((h >> 32) * (uint64_t)slots) >> 32);
+}
+
+static void clear_trie_hash(trie_t *trie)
+{
+    free(trie->disp);
+    free(trie->slots);
+    trie->disp = 0;
+    trie->slots = 0;
+    trie->buckets = 0;
+}
+
+/* Returns 0 when a perfect hash was found for the `n` dict entries. */
+static int build_trie_hash(trie_t *trie, int n)
+{
+    int i, j, k, d, b, size, nb = (n + PHASH_BUCKET_SIZE - 1) / PHASH_BUCKET_SIZE;
+    int *bucket = 0, *count = 0, *pending = 0;
+    uint64_t *h = 0;
+
+    trie->buckets = nb;
+    h = malloc((size_t)n * sizeof(h[0]));
+    bucket = malloc((size_t)n * sizeof(bucket[0]));
+    pending = malloc((size_t)n * sizeof(pending[0]));
+    count = calloc((size_t)nb, sizeof(count[0]));
+    trie->slots = malloc((size_t)n * sizeof(trie->slots[0]));
+    trie->disp = calloc((size_t)nb, sizeof(trie->disp[0]));
+    if (!h || !bucket || !pending || !count || !trie->slots || !trie->disp) {
+        goto failed;
+    }
+    for (i = 0; i < n; ++i) {
+        h[i] = phash_symbol(trie->dict[i].text, trie->dict[i].len);
+        for (j = 0; j < i; ++j) {
+            if (h[i] == h[j]) {
+                goto failed;
+            }
+        }
+        bucket[i] = phash_bucket(h[i], nb);
+        ++count[bucket[i]];
+        trie->slots[i] = -1;
+    }
+    for (size = n; size > 0; --size) {
+        for (b = 0; b < nb; ++b) {
+            if (count[b] != size) {
+                continue;
+            }
+            for (d = 0; d <= PHASH_MAX_DISP; ++d) {
+                for (k = 0, i = 0; i < n; ++i) {
+                    if (bucket[i] != b) {
+                        continue;
+                    }
+                    pending[k] = phash_slot(h[i], d, n);
+                    if (trie->slots[pending[k]] >= 0) {
+                        break;
+                    }
+                    for (j = 0; j < k && pending[j] != pending[k]; ++j) {
+                    }
+                    if (j < k) {
+                        break;
+                    }
+                    ++k;
+                }
+                if (i == n) {
+                    break;
+                }
+            }
+            if (d > PHASH_MAX_DISP) {
+                goto failed;
+            }
+            trie->disp[b] = (uint16_t)d;
+            for (i = 0; i < n; ++i) {
+                if (bucket[i] == b) {
+                    trie->slots[phash_slot(h[i], d, n)] = i;
+                }
+            }
+        }
+    }
+    free(h);
+    free(bucket);
+    free(pending);
+    free(count);
+    return 0;
+failed:
+    free(h);
+    free(bucket);
+    free(pending);
+    free(count);
+    clear_trie_hash(trie);
+    return -1;
+}
+
+static void gen_trie_hash(fb_output_t *out, trie_t *trie, int n)
+{
+    dict_entry_t *de;
+    int i;
+
+    println(out, "symbol_hash = flatcc_json_parser_symbol_hash(buf, end, &symbol_len);");
+    println(out, "switch (flatcc_json_parser_symbol_slot(symbol_hash, symbol_disp, %d, %d)) {",
+            trie->buckets, n);
+    for (i = 0; i < n; ++i) {
+        de = &trie->dict[trie->slots[i]];
+        println(out, "case %d: /* \"%.*s\" */", i, de->len, de->text); indent();
+        println(out, "if (symbol_len == %d && !memcmp(buf, \"%.*s\", %d)) {", de->len, de->len, de->text, de->len); indent();
+        trie->gen_match(out, trie->ct, de->data, de->hint, de->len);
+        println(out, "goto symbol_unmatched;");
+        unindent(); println(out, "}");
+        println(out, "break;");
+        unindent(); println(out, "}");
+        println(out, "goto symbol_unmatched;");
+        unindent();
+    }
+    println(out, "default:");
+    margin();
+    println(out, "symbol_unmatched:");
+    unmargin();
+    indent();
+    trie->gen_unmatched(out);
+    println(out, "break;");
+    unindent(); println(out, "}");
+}
+
+/*
+ * Names are matched in two steps: `gen_dispatch_vars` declares what
+ * the chosen method needs, and `gen_dispatch` matches the symbol at
+ * `buf`.
+ */
+static void gen_dispatch_vars(fb_output_t *out, trie_t *trie, int n)
+{
+    char line[16 * 8], *p;
+    int i, j;
+
+    if (out->opts->cgen_json_parser_hash && n > 0 && !trie->slots) {
+        build_trie_hash(trie, n);
+    }
+    if (!trie->slots) {
+        println(out, "uint64_t w;");
+        return;
+    }
+    println(out, "static const uint16_t symbol_disp[%d] = {", trie->buckets); indent();
+    for (i = 0; i < trie->buckets; i += 16) {
+        for (p = line, j = i; j < i + 16 && j < trie->buckets; ++j) {
+            p += sprintf(p, "%s%d", j > i ? ", " : "", (int)trie->disp[j]);
+        }
+        println(out, "%s%s", line, j < trie->buckets ? "," : "");
+    }
+    unindent(); println(out, "};");
+    println(out, "uint64_t symbol_hash;");
+    println(out, "size_t symbol_len;");
+}
+
+static void gen_dispatch(fb_output_t *out, trie_t *trie, int n)
+{
+    if (trie->slots) {
+        gen_trie_hash(out, trie, n);
+        return;
+    }
+    println(out, "w = flatcc_json_parser_symbol_part(buf, end);");
+    gen_trie(out, trie, 0, n - 1, 0);
+}
+
 
 /*
  * Parsing symbolic constants:
@@ -1323,14 +1535,14 @@ static int gen_enum_parser(fb_output_t *out, fb_compound_type_t *ct)
     } else {
         println(out, "const char *unmatched = buf;");
         println(out, "const char *mark;");
-        println(out, "uint64_t w;");
+        gen_dispatch_vars(out, &trie, n);
         println(out, "");
-        println(out, "w = flatcc_json_parser_symbol_part(buf, end);");
-        gen_trie(out, &trie, 0, n - 1, 0);
+        gen_dispatch(out, &trie, n);
         println(out, "return buf;");
         unindent(); println(out, "}");
     }
     println(out, "");
+    clear_trie_hash(&trie);
     clear_dict(trie.dict);
     return 0;
 }
@@ -1370,7 +1582,7 @@ static int gen_struct_parser_inline(fb_output_t *out, fb_compound_type_t *ct)
         println(out, "flatcc_builder_ref_t ref;");
         println(out, "void *pval;");
         println(out, "const char *mark;");
-        println(out, "uint64_t w;");
+        gen_dispatch_vars(out, &trie, n);
     }
     println(out, "");
     println(out, "buf = flatcc_json_parser_object_start(ctx, buf, end, &more);");
@@ -1380,8 +1592,7 @@ static int gen_struct_parser_inline(fb_output_t *out, fb_compound_type_t *ct)
         println(out, "buf = flatcc_json_parser_unmatched_symbol(ctx, buf, end);");
     } else {
         println(out, "buf = flatcc_json_parser_symbol_start(ctx, buf, end);");
-        println(out, "w = flatcc_json_parser_symbol_part(buf, end);");
-        gen_trie(out, &trie, 0, n - 1, 0);
+        gen_dispatch(out, &trie, n);
     }
     println(out, "buf = flatcc_json_parser_object_end(ctx, buf, end , &more);");
     unindent(); println(out, "}");
@@ -1395,6 +1606,7 @@ static int gen_struct_parser_inline(fb_output_t *out, fb_compound_type_t *ct)
     }
     unindent(); println(out, "}");
     println(out, "");
+    clear_trie_hash(&trie);
     clear_dict(trie.dict);
     return 0;
 }
@@ -1465,7 +1677,7 @@ static int gen_table_parser(fb_output_t *out, fb_compound_type_t *ct)
         println(out, "void *pval;");
         println(out, "flatcc_builder_ref_t ref, *pref;");
         println(out, "const char *mark;");
-        println(out, "uint64_t w;");
+        gen_dispatch_vars(out, &trie, n);
     }
     if (trie.union_total) {
         println(out, "size_t h_unions;");
@@ -1481,8 +1693,7 @@ static int gen_table_parser(fb_output_t *out, fb_compound_type_t *ct)
     println(out, "while (more) {"); indent();
     println(out, "buf = flatcc_json_parser_symbol_start(ctx, buf, end);");
     if (n > 0) {
-        println(out, "w = flatcc_json_parser_symbol_part(buf, end);");
-        gen_trie(out, &trie, 0, n - 1, 0);
+        gen_dispatch(out, &trie, n);
     } else {
         println(out, "/* Table has no fields. */");
         println(out, "buf = flatcc_json_parser_unmatched_symbol(ctx, buf, end);");
@@ -1531,6 +1742,25 @@ static int gen_table_parser(fb_output_t *out, fb_compound_type_t *ct)
             snt.text);
     unindent(); println(out, "}");
     println(out, "");
+    println(out, "static inline int %s_parse_json_as_root_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx, const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid, const flatcc_json_parser_parallel_t *parallel)", snt.text);
+    println(out, "{"); indent();
+    println(out, "return flatcc_json_parser_table_as_root_parallel(B, ctx, buf, bufsiz, flags, fid, %s_parse_json_table, parallel);",
+            snt.text);
+    unindent(); println(out, "}");
+    println(out, "");
+    println(out, "static inline int %s_parse_ndjson(flatcc_builder_t *B, flatcc_json_parser_t *ctx, const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid, flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count)", snt.text);
+    println(out, "{"); indent();
+    println(out, "return flatcc_json_parser_ndjson(B, ctx, buf, bufsiz, flags, fid, %s_parse_json_table, emit, emit_context, count);",
+            snt.text);
+    unindent(); println(out, "}");
+    println(out, "");
+    println(out, "static inline int %s_parse_ndjson_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx, const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid, flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count, const flatcc_json_parser_parallel_t *parallel)", snt.text);
+    println(out, "{"); indent();
+    println(out, "return flatcc_json_parser_ndjson_parallel(B, ctx, buf, bufsiz, flags, fid, %s_parse_json_table, emit, emit_context, count, parallel);",
+            snt.text);
+    unindent(); println(out, "}");
+    println(out, "");
+    clear_trie_hash(&trie);
     clear_dict(trie.dict);
     return 0;
 }
@@ -1607,6 +1837,32 @@ static int gen_union_parser(fb_output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+/* Zero terminated table member types for speculative union parsing. */
+static int gen_union_table_types(fb_output_t *out, fb_compound_type_t *ct)
+{
+    fb_scoped_name_t snt;
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    int n;
+    const char *s;
+
+    fb_clear(snt);
+    fb_compound_name(ct, &snt);
+    println(out, "static const uint8_t %s_json_union_table_types[] = {", snt.text);
+    indent(); indent();
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        symbol_name(sym, &n, &s);
+        if (member->type.type == vt_compound_type_ref &&
+                member->type.ct->symbol.kind == fb_is_table) {
+            println(out, "%u, /* %.*s */", (unsigned)member->value.u, n, s);
+        }
+    }
+    println(out, "0 };");
+    unindent(); unindent();
+    return 0;
+}
+
 static int gen_union_accept_type(fb_output_t *out, fb_compound_type_t *ct)
 {
     fb_scoped_name_t snt, snref;
@@ -1778,6 +2034,7 @@ static int gen_json_parser_prototypes(fb_output_t *out)
             fb_compound_name((fb_compound_type_t *)sym, &snt);
             println(out, "static const char *%s_parse_json_union(flatcc_json_parser_t *ctx, const char *buf, const char *end, uint8_t type, flatcc_builder_ref_t *pref);", snt.text);
             println(out, "static int %s_json_union_accept_type(uint8_t type);", snt.text);
+            gen_union_table_types(out, (fb_compound_type_t *)sym);
             /* A union also has an enum parser to get the type. */
             println(out, "static const char *%s_parse_json_enum(flatcc_json_parser_t *ctx, const char *buf, const char *end,", snt.text);
             indent(); indent();
@@ -364,6 +364,203 @@ static int gen_json_printer_struct(fb_output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+/*
+ * Default value as stored in a printer field descriptor. Floating point
+ * defaults are stored as their bit pattern so they compare exactly.
+ */
+static int print_field_default(fb_scalar_type_t st, const fb_value_t *value, fb_literal_t literal)
+{
+    fb_literal_t tmp;
+    uint32_t u32;
+    uint64_t u64;
+    float f;
+    double d;
+
+    if (value->type == vt_float && st == fb_float) {
+        f = (float)value->f;
+        memcpy(&u32, &f, sizeof(u32));
+        return sprintf(literal, "UINT64_C(0x%08"PRIx32")", u32);
+    }
+    if (value->type == vt_float && st == fb_double) {
+        d = (double)value->f;
+        memcpy(&u64, &d, sizeof(u64));
+        return sprintf(literal, "UINT64_C(0x%016"PRIx64")", u64);
+    }
+    if (!print_literal(st, value, tmp)) return 0;
+    return sprintf(literal, "(uint64_t)%s", tmp);
+}
+
+/* `flatcc --json-printer-table` alternative to the per field calls. */
+static int gen_json_printer_table_fields(fb_output_t *out, fb_compound_type_t *ct, fb_scoped_name_t *snt)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    fb_scoped_name_t snref;
+    fb_literal_t literal;
+    fb_scalar_type_t st;
+    const char *kind, *cast, *suffix;
+    int is_optional, is_union, count = 0;
+
+    fb_clear(snref);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        count += !(member->metadata_flags & fb_f_deprecated);
+    }
+    if (count == 0) {
+        fprintf(out->fp,
+                "static void %s_print_json_table(flatcc_json_printer_t *ctx, flatcc_json_printer_table_descriptor_t *td)\n"
+                "{\n}\n\n",
+                snt->text);
+        return 0;
+    }
+    fprintf(out->fp, "static const flatcc_json_printer_field_t %s_json_fields[] = {", snt->text);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        sym = &member->symbol;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        is_optional = !!(member->flags & fb_fm_optional);
+        kind = 0;
+        st = 0;
+        cast = 0;
+        suffix = 0;
+        is_union = 0;
+        strcpy(literal, "0");
+        switch (member->type.type) {
+        case vt_scalar_type:
+            st = member->type.st;
+            if (is_optional) {
+                kind = "optional";
+            } else {
+                kind = "scalar";
+                if (!print_field_default(st, &member->value, literal)) return -1;
+            }
+            break;
+        case vt_vector_type:
+            if (member->metadata_flags & (fb_f_base64 | fb_f_base64url)) {
+                kind = "base64_vector";
+                sprintf(literal, "%u", !(member->metadata_flags & fb_f_base64));
+            } else if (member->nest) {
+                fb_compound_name((fb_compound_type_t *)&member->nest->symbol, &snref);
+                if (member->nest->symbol.kind == fb_is_table) {
+                    kind = "nested_table";
+                    suffix = "_print_json_table";
+                } else {
+                    kind = "nested_struct";
+                    suffix = "_print_json_struct";
+                }
+            } else {
+                kind = "vector";
+                st = member->type.st;
+            }
+            break;
+        case vt_string_type:
+            kind = "string";
+            break;
+        case vt_vector_string_type:
+            kind = "string_vector";
+            break;
+        case vt_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_enum:
+                st = member->type.ct->type.st;
+#if FLATCC_JSON_PRINT_MAP_ENUMS
+                kind = is_optional ? "enum_optional" : "enum";
+                suffix = "_print_json_enum";
+#else
+                kind = is_optional ? "optional" : "scalar";
+#endif
+                if (!is_optional) {
+                    if (!print_field_default(st, &member->value, literal)) return -1;
+                }
+                break;
+            case fb_is_struct:
+                kind = "struct";
+                suffix = "_print_json_struct";
+                break;
+            case fb_is_table:
+                kind = "table";
+                suffix = "_print_json_table";
+                break;
+            case fb_is_union:
+                kind = "union";
+                suffix = "_print_json_union";
+                is_union = 1;
+                break;
+            default:
+                gen_panic(out, "internal error: unexpected compound type for table json_print");
+                return -1;
+            }
+            break;
+        case vt_vector_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_table:
+                kind = "table_vector";
+                suffix = "_print_json_table";
+                break;
+            case fb_is_enum:
+                st = member->type.ct->type.st;
+#if FLATCC_JSON_PRINT_MAP_ENUMS
+                kind = "enum_vector";
+                suffix = "_print_json_enum";
+#else
+                kind = "vector";
+#endif
+                break;
+            case fb_is_struct:
+                kind = "struct_vector";
+                suffix = "_print_json_struct";
+                sprintf(literal, "%"PRIu64, (uint64_t)member->size);
+                break;
+            case fb_is_union:
+                kind = "union_vector";
+                suffix = "_print_json_union";
+                is_union = 1;
+                break;
+            default:
+                gen_panic(out, "internal error: unexpected vector compound type for table json_print");
+                return -1;
+            }
+            break;
+        }
+        if (!kind) {
+            gen_panic(out, "internal error: unexpected member type for table json_print");
+            return -1;
+        }
+        if (is_union) {
+            fprintf(out->fp,
+                    "\n    { \"%.*s\", (flatcc_json_printer_generic_f *)%s_print_json_union_type, 0, %"PRIu64", %ld, "
+                    "flatcc_json_printer_kind_union_type, 0 },",
+                    (int)sym->ident->len, sym->ident->text, snref.text, member->id - 1, sym->ident->len);
+        }
+        if (suffix) {
+            cast = "(flatcc_json_printer_generic_f *)";
+        }
+        fprintf(out->fp,
+                "\n    { \"%.*s\", %s%s%s, %s, %"PRIu64", %ld, flatcc_json_printer_kind_%s, ",
+                (int)sym->ident->len, sym->ident->text,
+                cast ? cast : "", suffix ? snref.text : "0", suffix ? suffix : "",
+                literal, member->id, sym->ident->len, kind);
+        if (st) {
+            fprintf(out->fp, "flatcc_json_printer_type_%s },", scalar_type_prefix(st));
+        } else {
+            fprintf(out->fp, "0 },");
+        }
+    }
+    fprintf(out->fp, "\n};\n\n");
+    fprintf(out->fp,
+            "static void %s_print_json_table(flatcc_json_printer_t *ctx, flatcc_json_printer_table_descriptor_t *td)\n"
+            "{\n"
+            "    flatcc_json_printer_table_fields(ctx, td, %s_json_fields,\n"
+            "            sizeof(%s_json_fields) / sizeof(%s_json_fields[0]));\n"
+            "}\n\n",
+            snt->text, snt->text, snt->text, snt->text);
+    return 0;
+}
+
 static int gen_json_printer_table(fb_output_t *out, fb_compound_type_t *ct)
 {
     fb_symbol_t *sym;
@@ -377,6 +574,12 @@ static int gen_json_printer_table(fb_output_t *out, fb_compound_type_t *ct)
     fb_clear(snref);
     fb_compound_name(ct, &snt);
 
+    if (out->opts->cgen_json_printer_table) {
+        if (gen_json_printer_table_fields(out, ct, &snt)) {
+            goto fail;
+        }
+        goto as_root;
+    }
     /* Fields are printed in field id order for consistency across schema version. */
     fprintf(out->fp,
             "static void %s_print_json_table(flatcc_json_printer_t *ctx, flatcc_json_printer_table_descriptor_t *td)\n"
@@ -541,10 +744,36 @@ static int gen_json_printer_table(fb_output_t *out, fb_compound_type_t *ct)
         }
     }
     fprintf(out->fp, "\n}\n\n");
+as_root:
     fprintf(out->fp,
             "static inline int %s_print_json_as_root(flatcc_json_printer_t *ctx, const void *buf, size_t bufsiz, const char *fid)\n"
             "{\n    return flatcc_json_printer_table_as_root(ctx, buf, bufsiz, fid, %s_print_json_table);\n}\n\n",
             snt.text, snt.text);
+    /* Field ids for `flatcc_json_printer_projection_add`. */
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        fprintf(out->fp, "#define %s_%.*s_field_id %"PRIu64"\n",
+                snt.text, (int)sym->ident->len, sym->ident->text, member->id);
+    }
+    fprintf(out->fp, "\n");
+    /* One NDJSON line per element of table vectors when the table is root. */
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (member->type.type != vt_vector_compound_type_ref || member->type.ct->symbol.kind != fb_is_table) {
+            continue;
+        }
+        fb_compound_name(member->type.ct, &snref);
+        fprintf(out->fp,
+                "static inline int %s_%.*s_print_ndjson(flatcc_json_printer_t *ctx, const void *buf, size_t bufsiz, const char *fid)\n"
+                "{\n    return flatcc_json_printer_table_vector_as_ndjson(ctx, buf, bufsiz, fid, %"PRIu64", %s_print_json_table);\n}\n\n",
+                snt.text, (int)sym->ident->len, sym->ident->text, member->id, snref.text);
+    }
 done:
     return ret;
 fail:
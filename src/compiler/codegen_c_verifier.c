@@ -112,17 +112,16 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
         }
 
         if (first) {
-            fprintf(out->fp, "    int ret;\n    if ((ret = ");
-        } else {
-            fprintf(out->fp, ")) return ret;\n    if ((ret = ");
+            fprintf(out->fp, "    int ret;\n");
         }
+        fprintf(out->fp, "    if ((ret = ");
         first = 0;
         required = (member->metadata_flags & fb_f_required) != 0;
         switch (member->type.type) {
         case vt_scalar_type:
             fprintf(
                     out->fp,
-                    "flatcc_verify_field(td, %"PRIu64", %"PRIu64", %"PRIu16")",
+                    "flatcc_verify_field_inline(td, %"PRIu64", %"PRIu64", %"PRIu16")",
                     member->id, member->size, member->align);
             break;
         case vt_vector_type:
@@ -141,7 +140,7 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
                 }
             } else {
                 fprintf(out->fp,
-                        "flatcc_verify_vector_field(td, %"PRIu64", %d, %"PRIu64", %"PRIu16", INT64_C(%"PRIu64"))",
+                        "flatcc_verify_vector_field_inline(td, %"PRIu64", %d, %"PRIu64", %"PRIu16", INT64_C(%"PRIu64"))",
                         member->id, required, member->size, member->align, (uint64_t)FLATBUFFERS_COUNT_MAX(member->size));
             };
             break;
@@ -161,7 +160,7 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
             case fb_is_enum:
             case fb_is_struct:
                 fprintf(out->fp,
-                        "flatcc_verify_field(td, %"PRIu64", %"PRIu64", %"PRIu16")",
+                        "flatcc_verify_field_inline(td, %"PRIu64", %"PRIu64", %"PRIu16")",
                         member->id, member->size, member->align);
                 break;
             case fb_is_table:
@@ -190,7 +189,7 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
             case fb_is_enum:
             case fb_is_struct:
                 fprintf(out->fp,
-                        "flatcc_verify_vector_field(td, %"PRIu64", %d, %"PRIu64", %"PRIu16", INT64_C(%"PRIu64"))",
+                        "flatcc_verify_vector_field_inline(td, %"PRIu64", %d, %"PRIu64", %"PRIu16", INT64_C(%"PRIu64"))",
                         member->id, required, member->size, member->align, (uint64_t)FLATBUFFERS_COUNT_MAX(member->size));
                 break;
             case fb_is_union:
@@ -204,10 +203,9 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
             }
             break;
         }
-        fprintf(out->fp, " /* %.*s */", (int)sym->ident->len, sym->ident->text);
-    }
-    if (!first) {
-        fprintf(out->fp, ")) return ret;\n");
+        /* Only the failure path reports the field for diagnostics. */
+        fprintf(out->fp, " /* %.*s */)) return flatcc_verify_table_error(td, ret, %"PRIu64", \"%s\");\n",
+                (int)sym->ident->len, sym->ident->text, member->id, snt.text);
     }
     fprintf(out->fp, "    return flatcc_verify_ok;\n");
     fprintf(out->fp, "}\n\n");
@@ -239,6 +237,26 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
             "static inline int %s_verify_as_root_with_type_hash(const void *buf, size_t bufsiz, %sthash_t thash)\n"
             "{\n    return flatcc_verify_table_as_typed_root(buf, bufsiz, thash, &%s_verify_table);\n}\n\n",
             snt.text, nsc, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_visited(const void *buf, size_t bufsiz, flatcc_verify_visited_t *visited)\n"
+            "{\n    return flatcc_verify_table_as_root_with_visited(buf, bufsiz, %s_identifier, &%s_verify_table, visited);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_and_visited(const void *buf, size_t bufsiz, flatcc_verify_visited_t *visited)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_and_visited(buf, bufsiz, %s_identifier, &%s_verify_table, visited);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_diagnostics(const void *buf, size_t bufsiz, flatcc_verify_diagnostics_t *diag)\n"
+            "{\n    return flatcc_verify_table_as_root_with_diagnostics(buf, bufsiz, %s_identifier, &%s_verify_table, diag);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_and_diagnostics(const void *buf, size_t bufsiz, flatcc_verify_diagnostics_t *diag)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_and_diagnostics(buf, bufsiz, %s_identifier, &%s_verify_table, diag);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_partial(const void *buf, size_t bufsiz, flatcc_verify_visited_t *visited)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_partial(buf, bufsiz, %s_identifier, &%s_verify_table, visited);\n}\n\n",
+            snt.text, snt.text, snt.text);
     fprintf(out->fp,
             "static inline int %s_verify_as_root_with_type_hash_and_size(const void *buf, size_t bufsiz, %sthash_t thash)\n"
             "{\n    return flatcc_verify_table_as_typed_root_with_size(buf, bufsiz, thash, &%s_verify_table);\n}\n\n",
@@ -59,6 +59,8 @@ void flatcc_init_options(flatcc_options_t *opts)
     opts->cgen_reader = 0;
     opts->cgen_builder = 0;
     opts->cgen_json_parser = 0;
+    opts->cgen_json_parser_hash = 0;
+    opts->cgen_json_printer_table = 0;
     opts->cgen_spacing = FLATCC_CGEN_SPACING;
 
     opts->bgen_bfbs = FLATCC_BGEN_BFBS;
@@ -1895,6 +1895,32 @@ int flatcc_builder_get_level(flatcc_builder_t *B)
     return B->level;
 }
 
+void flatcc_builder_abandon_to_level(flatcc_builder_t *B, int level)
+{
+    while (B->level > level) {
+        switch (frame(type)) {
+        case flatcc_builder_table:
+            /* Clear vs stack like `end_table` does. */
+            memset(B->vs - 2, 0, sizeof(voffset_t) * (B->id_end + 2u));
+            B->vt_hash = frame(container.table.vt_hash);
+            B->id_end = frame(container.table.id_end);
+            B->vs = vs_ptr(frame(container.table.vs_end));
+            B->pl = pl_ptr(frame(container.table.pl_end));
+            break;
+        case flatcc_builder_buffer:
+            B->buffer_mark = frame(container.buffer.mark);
+            B->nest_id = frame(container.buffer.nest_id);
+            B->identifier = frame(container.buffer.identifier);
+            B->buffer_flags = frame(container.buffer.flags);
+            B->block_align = frame(container.buffer.block_align);
+            break;
+        default:
+            break;
+        }
+        exit_frame(B);
+    }
+}
+
 void flatcc_builder_set_max_level(flatcc_builder_t *B, int max_level)
 {
     B->max_level = max_level;
@@ -1,6 +1,8 @@
 #include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_flatbuffers.h"
 #include "flatcc/flatcc_json_parser.h"
 #include "flatcc/flatcc_assert.h"
+#include "flatcc/flatcc_alloc.h"
 
 #define uoffset_t flatbuffers_uoffset_t
 #define soffset_t flatbuffers_soffset_t
@@ -16,7 +18,14 @@
 #if FLATCC_USE_GRISU3 && !defined(PORTABLE_USE_GRISU3)
 #define PORTABLE_USE_GRISU3 1
 #endif
+#if !defined(PORTABLE_USE_EISEL_LEMIRE)
+#define PORTABLE_USE_EISEL_LEMIRE FLATCC_USE_EISEL_LEMIRE
+#endif
+#include "flatcc/portable/pparseint.h"
 #include "flatcc/portable/pparsefp.h"
+#if !defined(PORTABLE_BASE64_SIMD)
+#define PORTABLE_BASE64_SIMD (FLATCC_USE_SSE2 && FLATCC_USE_AVX2)
+#endif
 #include "flatcc/portable/pbase64.h"
 
 #if FLATCC_USE_SSE4_2
@@ -25,7 +34,17 @@
 #endif
 #endif
 
-#ifdef USE_SSE4_2
+#if FLATCC_USE_SSE2
+#include "flatcc/portable/psimd.h"
+#ifdef PORTABLE_SSE2
+#define USE_SSE2
+#if FLATCC_USE_AVX2 && defined(PORTABLE_AVX2)
+#define USE_AVX2
+#endif
+#endif
+#endif
+
+#if defined(USE_SSE4_2) && !defined(USE_SSE2)
 #include <nmmintrin.h>
 #define cmpistri(end, haystack, needle, flags)                              \
         if (end - haystack >= 16) do {                                      \
@@ -39,6 +58,109 @@
         } while(0)
 #endif
 
+#ifdef USE_SSE2
+/*
+ * Byte classification in the style of simdjson: each kernel compares a
+ * block against the bytes of interest and reduces the result to a bit
+ * mask with one bit per input byte. A run ends at the lowest set bit.
+ * Kernels stop short of the end of the buffer when less than a vector
+ * remains and leave the tail to the scalar code which also deals with
+ * the byte that ended the run.
+ *
+ * String runs are shared with the JSON printer, see psimd.h. Space
+ * runs consist of ' ' and '\t' only, so line breaks are still counted
+ * by the scalar code.
+ */
+static inline uint32_t sse2_space_mask(__m128i x)
+{
+    __m128i s = _mm_cmpeq_epi8(x, _mm_set1_epi8(0x20));
+    __m128i t = _mm_cmpeq_epi8(x, _mm_set1_epi8(0x09));
+
+    return ~(uint32_t)_mm_movemask_epi8(_mm_or_si128(s, t)) & 0xffff;
+}
+
+#define sse2_load(p) _mm_loadu_si128((const __m128i *)(p))
+
+static inline const char *sse2_space_run(const char *buf, const char *end)
+{
+    uint32_t m;
+
+    while (end - buf >= 32) {
+        m = sse2_space_mask(sse2_load(buf)) | (sse2_space_mask(sse2_load(buf + 16)) << 16);
+        if (m) {
+            return buf + portable_ctz32(m);
+        }
+        buf += 32;
+    }
+    if (end - buf >= 16) {
+        m = sse2_space_mask(sse2_load(buf));
+        if (m) {
+            return buf + portable_ctz32(m);
+        }
+        buf += 16;
+    }
+    return buf;
+}
+
+#ifdef USE_AVX2
+
+PORTABLE_TARGET_AVX2
+static inline uint32_t avx2_space_mask(__m256i x)
+{
+    __m256i s = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x20));
+    __m256i t = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x09));
+
+    return ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(s, t));
+}
+
+#define avx2_load(p) _mm256_loadu_si256((const __m256i *)(p))
+
+PORTABLE_TARGET_AVX2
+static const char *avx2_space_run(const char *buf, const char *end)
+{
+    uint64_t m;
+
+    while (end - buf >= 64) {
+        m = (uint64_t)avx2_space_mask(avx2_load(buf)) |
+            ((uint64_t)avx2_space_mask(avx2_load(buf + 32)) << 32);
+        if (m) {
+            return buf + portable_ctz64(m);
+        }
+        buf += 64;
+    }
+    if (end - buf >= 32) {
+        m = avx2_space_mask(avx2_load(buf));
+        if (m) {
+            return buf + portable_ctz64(m);
+        }
+        buf += 32;
+    }
+    return sse2_space_run(buf, end);
+}
+
+#endif /* USE_AVX2 */
+
+static inline const char *simd_string_run(const char *buf, const char *end)
+{
+#ifdef USE_AVX2
+    if (end - buf >= 32 && portable_cpu_has_avx2()) {
+        return portable_avx2_string_run(buf, end);
+    }
+#endif
+    return portable_sse2_string_run(buf, end);
+}
+
+static inline const char *simd_space_run(const char *buf, const char *end)
+{
+#ifdef USE_AVX2
+    if (end - buf >= 32 && portable_cpu_has_avx2()) {
+        return avx2_space_run(buf, end);
+    }
+#endif
+    return sse2_space_run(buf, end);
+}
+#endif /* USE_SSE2 */
+
 const char *flatcc_json_parser_error_string(int err)
 {
     switch (err) {
@@ -64,14 +186,9 @@ const char *flatcc_json_parser_set_error(flatcc_json_parser_t *ctx, const char *
 
 const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char *buf, const char *end)
 {
-/*
- * Disabled because it doesn't catch all control characters, but is
- * useful for performance testing.
- */
-#if 0
-//#ifdef USE_SSE4_2
-    cmpistri(end, buf, "\"\\\0\r\n\t\v\f", _SIDD_POSITIVE_POLARITY);
-#else
+#ifdef USE_SSE2
+    buf = simd_string_run(buf, end);
+#endif
     /*
      * Testing for signed char >= 0x20 would also capture UTF-8
      * encodings that we could verify, and also invalid encodings like
@@ -80,7 +197,6 @@ const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char
     while (buf != end && *buf != '\"' && ((unsigned char)*buf) >= 0x20 && *buf != '\\') {
         ++buf;
     }
-#endif
     if (buf == end) {
         return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_unterminated_string);
     }
@@ -96,7 +212,9 @@ const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char
 const char *flatcc_json_parser_space_ext(flatcc_json_parser_t *ctx, const char *buf, const char *end)
 {
 again:
-#ifdef USE_SSE4_2
+#if defined(USE_SSE2)
+    buf = simd_space_run(buf, end);
+#elif defined(USE_SSE4_2)
     /*
      * We can include line break, but then error reporting suffers and
      * it really makes no big difference.
@@ -513,6 +631,24 @@ const char *flatcc_json_parser_unmatched_symbol(flatcc_json_parser_t *ctx, const
     }
 }
 
+static inline const char *__flatcc_json_parser_digits(const char *buf, const char *end)
+{
+    uint64_t v;
+    int n;
+
+    while (end - buf >= 8) {
+        n = parse_integer_digits8(buf, &v);
+        buf += n;
+        if (n < 8) {
+            return buf;
+        }
+    }
+    while (buf != end && *buf >= '0' && *buf <= '9') {
+        ++buf;
+    }
+    return buf;
+}
+
 static const char *__flatcc_json_parser_number(flatcc_json_parser_t *ctx, const char *buf, const char *end)
 {
     if (buf == end) {
@@ -530,10 +666,7 @@ static const char *__flatcc_json_parser_number(flatcc_json_parser_t *ctx, const
         if (*buf < '1' || *buf > '9') {
             return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_invalid_numeric);
         }
-        ++buf;
-        while (buf != end && *buf >= '0' && *buf <= '9') {
-            ++buf;
-        }
+        buf = __flatcc_json_parser_digits(buf + 1, end);
     }
     if (buf != end) {
         if (*buf == '.') {
@@ -541,10 +674,7 @@ static const char *__flatcc_json_parser_number(flatcc_json_parser_t *ctx, const
             if (*buf < '0' || *buf > '9') {
                 return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_invalid_numeric);
             }
-            ++buf;
-            while (buf != end && *buf >= '0' && *buf <= '9') {
-                ++buf;
-            }
+            buf = __flatcc_json_parser_digits(buf + 1, end);
         }
     }
     if (buf != end && (*buf == 'e' || *buf == 'E')) {
@@ -751,11 +881,16 @@ again:
     return buf;
 }
 
-const char *flatcc_json_parser_integer(flatcc_json_parser_t *ctx, const char *buf, const char *end,
-        int *value_sign, uint64_t *value)
+/* Inlined into bulk vector parsers, see `flatcc_json_parser_integer`. */
+static inline const char *__flatcc_json_parser_integer(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, int *value_sign, uint64_t *value)
 {
+    static const uint64_t pow10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
     uint64_t x0, x = 0;
     const char *k;
+    int n;
 
     if (buf == end) {
         return buf;
@@ -763,13 +898,24 @@ const char *flatcc_json_parser_integer(flatcc_json_parser_t *ctx, const char *bu
     k = buf;
     *value_sign = *buf == '-';
     buf += *value_sign;
+    /* Any 19 digit value fits, so only the remaining digits need overflow checks. */
+    while (end - buf >= 8 && buf - k - *value_sign <= 11) {
+        if (!(n = parse_integer_digits8(buf, &x0))) {
+            break;
+        }
+        x = x * pow10[n] + x0;
+        buf += n;
+        if (n < 8) {
+            break;
+        }
+    }
     while (buf != end && *buf >= '0' && *buf <= '9') {
-        x0 = x;
-        x = x * 10 + (uint64_t)(*buf - '0');
-        if (x0 > x) {
-            return flatcc_json_parser_set_error(ctx, buf, end, value_sign ?
+        x0 = (uint64_t)(*buf - '0');
+        if (x > UINT64_MAX / 10 || (x == UINT64_MAX / 10 && x0 > UINT64_MAX % 10)) {
+            return flatcc_json_parser_set_error(ctx, buf, end, *value_sign ?
                     flatcc_json_parser_error_underflow : flatcc_json_parser_error_overflow);
         }
+        x = x * 10 + x0;
         ++buf;
     }
     if (buf == k) {
@@ -783,6 +929,12 @@ const char *flatcc_json_parser_integer(flatcc_json_parser_t *ctx, const char *bu
     return buf;
 }
 
+const char *flatcc_json_parser_integer(flatcc_json_parser_t *ctx, const char *buf, const char *end,
+        int *value_sign, uint64_t *value)
+{
+    return __flatcc_json_parser_integer(ctx, buf, end, value_sign, value);
+}
+
 /* Array Creation - depends on flatcc builder. */
 
 const char *flatcc_json_parser_build_uint8_vector_base64(flatcc_json_parser_t *ctx,
@@ -838,6 +990,80 @@ base64_failed:
             urlsafe ? flatcc_json_parser_error_base64url : flatcc_json_parser_error_base64);
 }
 
+/*
+ * `PARSE` parses a number at `buf` into `val`, or returns `buf` unchanged
+ * if there is no number. Integer parsing is inlined here.
+ */
+#define __flatcc_json_parser_define_extend_vector(TN, T, PARSE)             \
+const char *flatcc_json_parser_extend_ ## TN ## _vector(                    \
+        flatcc_json_parser_t *ctx, const char *buf, const char *end,        \
+        int *more)                                                          \
+{                                                                           \
+    T *pval = 0, val;                                                       \
+    size_t avail = 0;                                                       \
+    const char *mark;                                                       \
+                                                                            \
+    while (*more && buf != end &&                                           \
+            (*buf == '-' || (*buf >= '0' && *buf <= '9'))) {                \
+        buf = PARSE(TN, ctx, (mark = buf), end, &val);                      \
+        if (buf == mark) {                                                  \
+            break;                                                          \
+        }                                                                   \
+        if (avail == 0) {                                                   \
+            avail = FLATCC_JSON_PARSE_VECTOR_CHUNK;                         \
+            if (!(pval = flatcc_builder_extend_vector(ctx->ctx, avail))) {  \
+                goto failed;                                                \
+            }                                                               \
+        }                                                                   \
+        flatbuffers_ ## TN ## _write_to_pe(pval++, val);                    \
+        --avail;                                                            \
+        buf = flatcc_json_parser_array_end(ctx, buf, end, more);            \
+    }                                                                       \
+    if (avail && flatcc_builder_truncate_vector(ctx->ctx, avail)) {         \
+        goto failed;                                                        \
+    }                                                                       \
+    return buf;                                                             \
+failed:                                                                     \
+    return flatcc_json_parser_set_error(ctx, buf, end,                      \
+            flatcc_json_parser_error_runtime);                              \
+}
+
+#define __flatcc_json_parser_extend_integer(TN, ctx, buf, end, v)           \
+    __flatcc_json_parser_extend_integer_ ## TN(ctx, buf, end, v)
+
+#define __flatcc_json_parser_define_extend_integer(TN, T)                   \
+static inline const char *__flatcc_json_parser_extend_integer_ ## TN(       \
+        flatcc_json_parser_t *ctx, const char *buf, const char *end, T *v)  \
+{                                                                           \
+    uint64_t value = 0;                                                     \
+    int value_sign = 0;                                                     \
+    const char *mark = buf;                                                 \
+                                                                            \
+    buf = __flatcc_json_parser_integer(ctx, buf, end, &value_sign, &value); \
+    if (buf == mark) {                                                      \
+        return buf;                                                         \
+    }                                                                       \
+    return flatcc_json_parser_coerce_ ## TN(ctx, buf, end, value_sign, value, v); \
+}
+
+#define __flatcc_json_parser_extend_real(TN, ctx, buf, end, v)              \
+    flatcc_json_parser_ ## TN(ctx, buf, end, v)
+
+#define __flatcc_json_parser_define_extend_integer_vector(TN, T)            \
+__flatcc_json_parser_define_extend_integer(TN, T)                           \
+__flatcc_json_parser_define_extend_vector(TN, T, __flatcc_json_parser_extend_integer)
+
+__flatcc_json_parser_define_extend_integer_vector(uint64, uint64_t)
+__flatcc_json_parser_define_extend_integer_vector(uint32, uint32_t)
+__flatcc_json_parser_define_extend_integer_vector(uint16, uint16_t)
+__flatcc_json_parser_define_extend_integer_vector(uint8, uint8_t)
+__flatcc_json_parser_define_extend_integer_vector(int64, int64_t)
+__flatcc_json_parser_define_extend_integer_vector(int32, int32_t)
+__flatcc_json_parser_define_extend_integer_vector(int16, int16_t)
+__flatcc_json_parser_define_extend_integer_vector(int8, int8_t)
+__flatcc_json_parser_define_extend_vector(float, float, __flatcc_json_parser_extend_real)
+__flatcc_json_parser_define_extend_vector(double, double, __flatcc_json_parser_extend_real)
+
 const char *flatcc_json_parser_char_array(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, char *s, size_t n)
 {
@@ -895,7 +1121,9 @@ const char *flatcc_json_parser_build_string(flatcc_json_parser_t *ctx,
 
     buf = flatcc_json_parser_string_start(ctx, buf, end);
     buf = flatcc_json_parser_string_part(ctx, (mark = buf), end);
+    ++ctx->stats.strings;
     if (buf != end && *buf == '\"') {
+        ++ctx->stats.direct_strings;
         *ref = flatcc_builder_create_string(ctx->ctx, mark, (size_t)(buf - mark));
     } else {
         if (flatcc_builder_start_string(ctx->ctx) ||
@@ -942,6 +1170,16 @@ failed:
  * is known. This can happen recursively with nested tables containing
  * unions which is why we need to have a stack frame.
  *
+ * Generated parsers may instead call the speculative variant with the
+ * union's table member types. A table value is then parsed as each of
+ * these types in turn and the first that parses is kept along with the
+ * backtracking pointer. If the type that follows matches, the value
+ * was read only once. Otherwise it is reparsed as above and the
+ * speculative table is left unreferenced in the buffer. A failed
+ * attempt is undone by restoring the parser context and abandoning the
+ * builder and user frames it left open. To bound the cost, union values
+ * nested inside a speculative parse are not speculated on.
+ *
  * If the type field is stored first we just store the type in the
  * custom frame and immediately parses the table with the right type
  * once we see it. The parse will be much faster and we can strongly
@@ -975,12 +1213,17 @@ failed:
  * `NONE = 0`.
  */
 
+static const char *skip_union_value(flatcc_json_parser_t *ctx, const char *buf, const char *end);
+
 typedef struct {
     const char *backtrace;
     const char *line_start;
     int line;
     uint8_t type_present;
     uint8_t type;
+    /* Type and table of a successful speculative parse. */
+    uint8_t ref_type;
+    flatcc_builder_ref_t ref;
     /* Union vectors: */
     uoffset_t count;
     size_t h_types;
@@ -1020,13 +1263,55 @@ const char *flatcc_json_parser_finalize_unions(flatcc_json_parser_t *ctx,
     return buf;
 }
 
+/*
+ * Returns the end of the value parsed as the first of `table_types`
+ * that succeeds, or null with the parser and builder state unchanged
+ * if none does.
+ */
+static const char *speculate_union_value(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, flatcc_json_parser_union_f *union_parser,
+        const uint8_t *table_types, uint8_t *type, flatcc_builder_ref_t *ref)
+{
+    flatcc_json_parser_t saved = *ctx;
+    int level = flatcc_builder_get_level(ctx->ctx);
+    size_t user_frame = flatcc_builder_get_current_user_frame(ctx->ctx);
+    const char *next;
+
+    ctx->speculating = 1;
+    for (; *table_types; ++table_types) {
+        next = union_parser(ctx, buf, end, *table_types, ref);
+        if (!ctx->error) {
+            ctx->speculating = 0;
+            *type = *table_types;
+            return next;
+        }
+        *ctx = saved;
+        ctx->speculating = 1;
+        flatcc_builder_abandon_to_level(ctx->ctx, level);
+        while (flatcc_builder_get_current_user_frame(ctx->ctx) != user_frame) {
+            flatcc_builder_exit_user_frame(ctx->ctx);
+        }
+    }
+    ctx->speculating = 0;
+    return 0;
+}
+
 const char *flatcc_json_parser_union(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, size_t union_index,
         flatbuffers_voffset_t id, size_t handle, flatcc_json_parser_union_f *union_parser)
+{
+    return flatcc_json_parser_union_speculative(ctx, buf, end, union_index, id, handle, union_parser, 0);
+}
+
+const char *flatcc_json_parser_union_speculative(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, size_t union_index,
+        flatbuffers_voffset_t id, size_t handle,
+        flatcc_json_parser_union_f *union_parser, const uint8_t *table_types)
 {
     __flatcc_json_parser_union_frame_t *f = flatcc_builder_get_user_frame_ptr(ctx->ctx, handle);
     __flatcc_json_parser_union_entry_t *e = &f->unions[union_index];
     flatcc_builder_union_ref_t uref;
+    const char *next = 0;
 
     if (e->backtrace) {
         return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_duplicate);
@@ -1036,7 +1321,19 @@ const char *flatcc_json_parser_union(flatcc_json_parser_t *ctx,
         ++f->union_count;
         e->line = ctx->line;
         e->line_start = ctx->line_start;
-        buf = flatcc_json_parser_generic_json(ctx, (e->backtrace = buf), end);
+        e->backtrace = buf;
+        if (table_types && !ctx->speculating && buf != end && *buf == '{') {
+            uref.type = 0;
+            uref.value = 0;
+            next = speculate_union_value(ctx, buf, end, union_parser, table_types,
+                    &uref.type, &uref.value);
+            /* The parse may have moved the user frame. */
+            f = flatcc_builder_get_user_frame_ptr(ctx->ctx, handle);
+            e = &f->unions[union_index];
+            e->ref_type = uref.type;
+            e->ref = uref.value;
+        }
+        buf = next ? next : skip_union_value(ctx, buf, end);
     } else {
         uref.type = e->type;
         if (e->type == 0) {
@@ -1090,11 +1387,20 @@ const char *flatcc_json_parser_union_type(flatcc_json_parser_t *ctx,
      *
      * IMPORTANT 2: Do not assign buf here. We are backtracking.
      */
+    uref.type = e->type;
+    if (e->ref && e->ref_type == e->type) {
+        /* The speculative parse already built the value. */
+        uref.value = e->ref;
+        if (flatcc_builder_table_add_union(ctx->ctx, id, uref)) {
+            return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_duplicate);
+        }
+        return buf;
+    }
+    ++ctx->stats.union_reparses;
     line = ctx->line;
     line_start = ctx->line_start;
     ctx->line = e->line;
     ctx->line_start = e->line_start;
-    uref.type = e->type;
     if (end == union_parser(ctx, e->backtrace, end, e->type, &uref.value)) {
         return end;
     }
@@ -1160,7 +1466,7 @@ const char *flatcc_json_parser_union_vector(flatcc_json_parser_t *ctx,
         ++f->union_count;
         e->line = ctx->line;
         e->line_start = ctx->line_start;
-        buf = flatcc_json_parser_generic_json(ctx, (e->backtrace = buf), end);
+        buf = skip_union_value(ctx, (e->backtrace = buf), end);
     } else {
         --f->union_count;
         buf = _parse_union_vector(ctx, buf, end, e->h_types, e->count, id, union_parser);
@@ -1239,6 +1545,7 @@ const char *flatcc_json_parser_union_type_vector(flatcc_json_parser_t *ctx,
     }
     FLATCC_ASSERT(f->union_count);
     --f->union_count;
+    ++ctx->stats.union_reparses;
     line = ctx->line;
     line_start = ctx->line_start;
     ctx->line = e->line;
@@ -1256,16 +1563,571 @@ failed:
     return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_runtime);
 }
 
-int flatcc_json_parser_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+/*
+ * Block string tracking.
+ *
+ * Input is classified 64 bytes at a time into bit masks with one bit
+ * per byte. Escaped characters follow an odd number of backslashes and
+ * are found by walking the backslashes in the block, which are rare.
+ * The prefix xor of unescaped quotes gives a mask of bytes inside
+ * strings, including the opening quote but not the closing quote.
+ * State carried between blocks is whether the first byte is escaped
+ * and whether it is inside a string.
+ */
+typedef struct block_state {
+    uint64_t escaped, in_string;
+} block_state_t;
+
+static inline unsigned block_ctz64(uint64_t x)
+{
+#if defined(USE_SSE2)
+    return portable_ctz64(x);
+#elif defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+static inline uint64_t block_prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/*
+ * Finds unescaped backslashes and quotes and returns the mask of bytes
+ * inside strings.
+ */
+static inline uint64_t block_strings(block_state_t *st, uint64_t backslash,
+        uint64_t *quote, uint64_t *escape)
+{
+    uint64_t escaped, todo, bit, next, in_string;
+
+    escaped = st->escaped;
+    st->escaped = 0;
+    todo = backslash & ~escaped;
+    while (todo) {
+        bit = todo & (~todo + 1);
+        next = bit << 1;
+        if (!next) {
+            st->escaped = 1;
+        }
+        escaped |= next;
+        todo &= ~(bit | next);
+    }
+    *escape = backslash & ~escaped;
+    *quote &= ~escaped;
+    in_string = block_prefix_xor(*quote) ^ st->in_string;
+    st->in_string = 0 - (in_string >> 63);
+    return in_string;
+}
+
+/*
+ * Skipping union values that precede their type.
+ *
+ * The value is parsed by the typed union parser once the type is
+ * known, so the skip only has to find the end of the value and keep
+ * line numbers. Brackets outside strings are matched a block at a time
+ * with the block string tracking above, rather than
+ * validating every token as `flatcc_json_parser_generic_json` does.
+ * Input that the string tracking cannot handle is skipped generically,
+ * which also reports the error.
+ *
+ * This is the fallback when a speculative parse is not possible or did
+ * not match the type. The value is then read twice, but the first read
+ * is cheap.
+ */
+typedef struct skip_masks {
+    uint64_t backslash, quote, open, close, cr, lf, control;
+} skip_masks_t;
+
+typedef struct skip_state {
+    block_state_t st;
+    uint64_t cr;
+    int depth, lines;
+    /* Offset of the last line start, if any. */
+    size_t line_start;
+} skip_state_t;
+
+static inline unsigned skip_popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    unsigned n = 0;
+
+    while (x) {
+        x &= x - 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* Counts lines as space handling does, where \r\n is a single break. */
+static inline void skip_lines(skip_state_t *s, const skip_masks_t *m, size_t base, uint64_t mask)
+{
+    uint64_t cr = m->cr & mask, lf = m->lf & mask, breaks = cr | lf;
+    unsigned i = 63;
+
+    s->lines += (int)(skip_popcount64(cr) + skip_popcount64(lf & ~((m->cr << 1) | s->cr)));
+    s->cr = m->cr >> 63;
+    if (breaks) {
+        while (!(breaks >> i)) {
+            --i;
+        }
+        s->line_start = base + i + 1;
+    }
+}
+
+/*
+ * Returns the offset after the closing bracket in the block, 0 if it is
+ * not in the block, or -1 if the block cannot be handled.
+ */
+static inline int skip_block(skip_state_t *s, const skip_masks_t *m, size_t base)
+{
+    uint64_t escape, quote = m->quote, in_string, brackets;
+    unsigned i;
+
+    in_string = block_strings(&s->st, m->backslash, &quote, &escape);
+    if ((m->control & in_string) || (escape & ~in_string)) {
+        return -1;
+    }
+    brackets = (m->open | m->close) & ~in_string;
+    while (brackets) {
+        i = block_ctz64(brackets);
+        if ((m->open >> i) & 1) {
+            ++s->depth;
+        } else if (--s->depth == 0) {
+            skip_lines(s, m, base, i == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (i + 1)) - 1);
+            return (int)i + 1;
+        }
+        brackets &= brackets - 1;
+    }
+    skip_lines(s, m, base, ~(uint64_t)0);
+    return 0;
+}
+
+static inline void skip_classify(const char *buf, skip_masks_t *m)
+{
+    uint64_t bit = 1;
+    int i;
+
+    memset(m, 0, sizeof(*m));
+    for (i = 0; i < 64; ++i, bit <<= 1) {
+        switch (buf[i]) {
+        case '\\': m->backslash |= bit; break;
+        case '\"': m->quote |= bit; break;
+        case '{': case '[': m->open |= bit; break;
+        case '}': case ']': m->close |= bit; break;
+        case 0x0d: m->cr |= bit; break;
+        case 0x0a: m->lf |= bit; break;
+        }
+        if ((unsigned char)buf[i] < 0x20) {
+            m->control |= bit;
+        }
+    }
+}
+
+/*
+ * Runs `block` on all whole blocks and updates `*k` to the first byte
+ * not scanned, or to the byte after the closing bracket when found.
+ */
+#define skip_blocks(classify, block, buf, bufsiz, k, s)                     \
+    do {                                                                    \
+        skip_masks_t m;                                                     \
+        int r;                                                              \
+        for (; bufsiz - *k >= 64; *k += 64) {                               \
+            classify(buf + *k, &m);                                         \
+            if ((r = block(s, &m, *k))) {                                   \
+                if (r > 0) {                                                \
+                    *k += (size_t)r;                                        \
+                    return 1;                                               \
+                }                                                           \
+                return -1;                                                  \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+#ifndef USE_SSE2
+static int skip_blocks_scalar(const char *buf, size_t bufsiz, size_t *k, skip_state_t *s)
+{
+    skip_blocks(skip_classify, skip_block, buf, bufsiz, k, s);
+    return 0;
+}
+#endif
+
+#ifdef USE_SSE2
+
+#define sse2_movemask64(x, i) ((uint64_t)(uint32_t)_mm_movemask_epi8(x) << (i))
+
+static inline void skip_classify_sse2(const char *buf, skip_masks_t *m)
+{
+    __m128i x, y;
+    int i;
+
+    memset(m, 0, sizeof(*m));
+    for (i = 0; i < 64; i += 16) {
+        x = sse2_load(buf + i);
+        y = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        m->backslash |= sse2_movemask64(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\')), i);
+        m->quote |= sse2_movemask64(_mm_cmpeq_epi8(x, _mm_set1_epi8('\"')), i);
+        m->open |= sse2_movemask64(_mm_cmpeq_epi8(y, _mm_set1_epi8('{')), i);
+        m->close |= sse2_movemask64(_mm_cmpeq_epi8(y, _mm_set1_epi8('}')), i);
+        m->cr |= sse2_movemask64(_mm_cmpeq_epi8(x, _mm_set1_epi8(0x0d)), i);
+        m->lf |= sse2_movemask64(_mm_cmpeq_epi8(x, _mm_set1_epi8(0x0a)), i);
+        m->control |= sse2_movemask64(portable_sse2_control_bytes(x), i);
+    }
+}
+
+static int skip_blocks_sse2(const char *buf, size_t bufsiz, size_t *k, skip_state_t *s)
+{
+    skip_blocks(skip_classify_sse2, skip_block, buf, bufsiz, k, s);
+    return 0;
+}
+
+#ifdef USE_AVX2
+
+#define avx2_movemask64(x, i) ((uint64_t)(uint32_t)_mm256_movemask_epi8(x) << (i))
+
+PORTABLE_TARGET_AVX2
+static inline void skip_classify_avx2(const char *buf, skip_masks_t *m)
+{
+    __m256i x, y;
+    int i;
+
+    memset(m, 0, sizeof(*m));
+    for (i = 0; i < 64; i += 32) {
+        x = avx2_load(buf + i);
+        y = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        m->backslash |= avx2_movemask64(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\')), i);
+        m->quote |= avx2_movemask64(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\"')), i);
+        m->open |= avx2_movemask64(_mm256_cmpeq_epi8(y, _mm256_set1_epi8('{')), i);
+        m->close |= avx2_movemask64(_mm256_cmpeq_epi8(y, _mm256_set1_epi8('}')), i);
+        m->cr |= avx2_movemask64(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x0d)), i);
+        m->lf |= avx2_movemask64(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x0a)), i);
+        m->control |= avx2_movemask64(portable_avx2_control_bytes(x), i);
+    }
+}
+
+PORTABLE_TARGET_AVX2
+static int skip_blocks_avx2(const char *buf, size_t bufsiz, size_t *k, skip_state_t *s)
+{
+    skip_blocks(skip_classify_avx2, skip_block, buf, bufsiz, k, s);
+    return 0;
+}
+
+#endif /* USE_AVX2 */
+#endif /* USE_SSE2 */
+
+static const char *skip_union_value(flatcc_json_parser_t *ctx, const char *buf, const char *end)
+{
+    skip_state_t s;
+    skip_masks_t m;
+    char tail[64];
+    size_t k = 0, bufsiz = (size_t)(end - buf);
+    int ret;
+
+    /* Strings and scalars are short. */
+    if (buf == end || (*buf != '{' && *buf != '[')) {
+        return flatcc_json_parser_generic_json(ctx, buf, end);
+    }
+    memset(&s, 0, sizeof(s));
+#if defined(USE_AVX2)
+    if (portable_cpu_has_avx2()) {
+        ret = skip_blocks_avx2(buf, bufsiz, &k, &s);
+    } else {
+        ret = skip_blocks_sse2(buf, bufsiz, &k, &s);
+    }
+#elif defined(USE_SSE2)
+    ret = skip_blocks_sse2(buf, bufsiz, &k, &s);
+#else
+    ret = skip_blocks_scalar(buf, bufsiz, &k, &s);
+#endif
+    if (ret == 0 && k < bufsiz) {
+        memset(tail, 0x20, sizeof(tail));
+        memcpy(tail, buf + k, bufsiz - k);
+        skip_classify(tail, &m);
+        if ((ret = skip_block(&s, &m, k)) > 0) {
+            k += (size_t)ret;
+        }
+    }
+    if (ret <= 0) {
+        return flatcc_json_parser_generic_json(ctx, buf, end);
+    }
+    ctx->line += s.lines;
+    if (s.lines) {
+        ctx->line_start = buf + s.line_start;
+    }
+    /* Consume trailing space as the generic skip does. */
+    return flatcc_json_parser_space(ctx, buf + k, end);
+}
+
+/*
+ * Splitting table vectors for parallel parsing.
+ *
+ * The array is scanned with the union value skip classifiers, starting
+ * just inside the opening bracket. The first element starting at least
+ * `chunk` bytes after the previous split point becomes the next split
+ * point, until the closing bracket is found.
+ */
+typedef struct split_state {
+    block_state_t st;
+    int depth;
+    size_t chunk, next, count, capacity;
+    size_t *splits;
+} split_state_t;
+
+static inline int split_block(split_state_t *s, const skip_masks_t *m, size_t base)
+{
+    uint64_t escape, quote = m->quote, in_string, brackets;
+    size_t *p;
+    unsigned i;
+
+    in_string = block_strings(&s->st, m->backslash, &quote, &escape);
+    if ((m->control & in_string) || (escape & ~in_string)) {
+        return -1;
+    }
+    brackets = (m->open | m->close) & ~in_string;
+    while (brackets) {
+        i = block_ctz64(brackets);
+        if ((m->open >> i) & 1) {
+            if (s->depth++ == 1 && base + i >= s->next) {
+                if (s->count == s->capacity) {
+                    s->capacity = s->capacity ? 2 * s->capacity : 64;
+                    if (!(p = FLATCC_JSON_PARSER_REALLOC(s->splits, s->capacity * sizeof(size_t)))) {
+                        return -1;
+                    }
+                    s->splits = p;
+                }
+                s->splits[s->count++] = base + i;
+                s->next = base + i + s->chunk;
+            }
+        } else if (--s->depth == 0) {
+            return (int)i + 1;
+        }
+        brackets &= brackets - 1;
+    }
+    return 0;
+}
+
+#ifndef USE_SSE2
+static int split_blocks_scalar(const char *buf, size_t bufsiz, size_t *k, split_state_t *s)
+{
+    skip_blocks(skip_classify, split_block, buf, bufsiz, k, s);
+    return 0;
+}
+#endif
+
+#ifdef USE_SSE2
+
+static int split_blocks_sse2(const char *buf, size_t bufsiz, size_t *k, split_state_t *s)
+{
+    skip_blocks(skip_classify_sse2, split_block, buf, bufsiz, k, s);
+    return 0;
+}
+
+#ifdef USE_AVX2
+
+PORTABLE_TARGET_AVX2
+static int split_blocks_avx2(const char *buf, size_t bufsiz, size_t *k, split_state_t *s)
+{
+    skip_blocks(skip_classify_avx2, split_block, buf, bufsiz, k, s);
+    return 0;
+}
+
+#endif /* USE_AVX2 */
+#endif /* USE_SSE2 */
+
+/* Returns 0 if the closing bracket was found. */
+static int split_table_vector(const char *buf, size_t bufsiz, split_state_t *s)
+{
+    skip_masks_t m;
+    char tail[64];
+    size_t k = 0;
+    int ret;
+
+#if defined(USE_AVX2)
+    if (portable_cpu_has_avx2()) {
+        ret = split_blocks_avx2(buf, bufsiz, &k, s);
+    } else {
+        ret = split_blocks_sse2(buf, bufsiz, &k, s);
+    }
+#elif defined(USE_SSE2)
+    ret = split_blocks_sse2(buf, bufsiz, &k, s);
+#else
+    ret = split_blocks_scalar(buf, bufsiz, &k, s);
+#endif
+    if (ret == 0 && k < bufsiz) {
+        memset(tail, 0x20, sizeof(tail));
+        memcpy(tail, buf + k, bufsiz - k);
+        skip_classify(tail, &m);
+        ret = split_block(s, &m, k);
+    }
+    return ret > 0 ? 0 : -1;
+}
+
+/* A range of elements parsed into a buffer of its own. */
+typedef struct parallel_job {
+    const char *buf;
+    /* Start of the next range, or null for the last range. */
+    const char *stop;
+    const char *end_loc;
+    const char *line_start;
+    int lines;
+    int error;
+    void *data;
+    size_t size;
+    uint16_t align;
+} parallel_job_t;
+
+typedef struct parallel_tables {
+    flatcc_json_parser_table_f *parser;
+    flatcc_json_parser_flags_t flags;
+    const char *end;
+    parallel_job_t *jobs;
+} parallel_tables_t;
+
+/*
+ * The buffer root is an offset vector of the parsed tables. Split points
+ * are only known to be at the start of a value at array depth, so a
+ * range must end exactly at the next split point, and the last range
+ * at the end of the array, for the split to be trusted.
+ */
+static void parse_parallel_job(void *job_context, size_t index)
+{
+    parallel_tables_t *P = job_context;
+    parallel_job_t *J = P->jobs + index;
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_json_parser_t ctx;
+    flatcc_builder_ref_t ref, *pref;
+    const char *buf = J->buf;
+    int more = 1;
+
+    J->error = -1;
+    if (flatcc_builder_init(B)) {
+        return;
+    }
+    flatcc_json_parser_init(&ctx, B, buf, P->end, P->flags);
+    if (flatcc_builder_start_buffer(B, 0, 0, 0) || flatcc_builder_start_offset_vector(B)) goto done;
+    while (more && buf != J->stop) {
+        buf = P->parser(&ctx, buf, P->end, &ref);
+        if (ctx.error || !ref || !(pref = flatcc_builder_extend_offset_vector(B, 1))) goto done;
+        *pref = ref;
+        buf = flatcc_json_parser_array_end(&ctx, buf, P->end, &more);
+        if (ctx.error || (J->stop && buf > J->stop)) goto done;
+    }
+    if (J->stop ? !more : more) goto done;
+    if (!(ref = flatcc_builder_end_offset_vector(B)) || !flatcc_builder_end_buffer(B, ref)) goto done;
+    if (!(J->data = flatcc_builder_finalize_aligned_buffer(B, &J->size))) goto done;
+    J->align = flatcc_builder_get_buffer_alignment(B);
+    J->end_loc = buf;
+    J->lines = ctx.line - 1;
+    J->line_start = ctx.line_start;
+    J->error = 0;
+done:
+    flatcc_builder_clear(B);
+}
+
+const char *flatcc_json_parser_parallel_tables_ext(flatcc_json_parser_t *ctx,
+        const char *buf, const char *end, int *more, flatcc_json_parser_table_f *parser)
+{
+    const flatcc_json_parser_parallel_t *parallel = ctx->parallel;
+    size_t chunk = parallel->chunk_size ? parallel->chunk_size : FLATCC_JSON_PARSER_PARALLEL_CHUNK;
+    split_state_t s;
+    parallel_tables_t P;
+    parallel_job_t *J;
+    flatcc_builder_ref_t blob, *pref;
+    const uint8_t *base, *p;
+    size_t i, k, n, skip, count = 0;
+
+    if ((size_t)(end - buf) < 2 * chunk) {
+        return buf;
+    }
+    memset(&s, 0, sizeof(s));
+    memset(&P, 0, sizeof(P));
+    s.depth = 1;
+    s.chunk = chunk;
+    s.next = chunk;
+    if (split_table_vector(buf, (size_t)(end - buf), &s) || s.count == 0) goto done;
+    count = s.count + 1;
+    if (!(P.jobs = FLATCC_JSON_PARSER_ALLOC(count * sizeof(parallel_job_t)))) goto done;
+    memset(P.jobs, 0, count * sizeof(parallel_job_t));
+    P.parser = parser;
+    P.flags = ctx->flags;
+    P.end = end;
+    for (i = 0; i < count; ++i) {
+        P.jobs[i].buf = i ? buf + s.splits[i - 1] : buf;
+        P.jobs[i].stop = i + 1 < count ? buf + s.splits[i] : 0;
+    }
+    parallel->run(parallel->run_context, parse_parallel_job, &P, count);
+    for (i = 0; i < count; ++i) {
+        if (P.jobs[i].error) goto done;
+    }
+    for (i = 0; i < count; ++i) {
+        J = P.jobs + i;
+        /*
+         * Offsets are relative, so the buffer content is valid at any
+         * location with the same alignment. The root vector was created
+         * last and is at the front, so it is left out where alignment
+         * permits.
+         */
+        base = J->data;
+        p = base + __flatbuffers_uoffset_read_from_pe(base);
+        n = __flatbuffers_uoffset_read_from_pe(p);
+        skip = (size_t)(p - base) + (n + 1) * sizeof(flatbuffers_uoffset_t);
+        skip -= skip % J->align;
+        if (!(blob = flatcc_builder_create_struct(ctx->ctx, base + skip, J->size - skip, J->align))) goto failed;
+        if (!(pref = flatcc_builder_extend_offset_vector(ctx->ctx, n))) goto failed;
+        for (k = 0; k < n; ++k) {
+            p += sizeof(flatbuffers_uoffset_t);
+            pref[k] = blob + (flatcc_builder_ref_t)((size_t)(p - base) - skip + __flatbuffers_uoffset_read_from_pe(p));
+        }
+        ctx->line += J->lines;
+        if (J->lines) {
+            ctx->line_start = J->line_start;
+        }
+    }
+    *more = 0;
+    buf = P.jobs[count - 1].end_loc;
+    goto done;
+failed:
+    buf = flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_runtime);
+done:
+    for (i = 0; P.jobs && i < count; ++i) {
+        if (P.jobs[i].data) {
+            flatcc_builder_aligned_free(P.jobs[i].data);
+        }
+    }
+    if (P.jobs) {
+        FLATCC_JSON_PARSER_FREE(P.jobs);
+    }
+    if (s.splits) {
+        FLATCC_JSON_PARSER_FREE(s.splits);
+    }
+    return buf;
+}
+
+/* Expects an initialized parser context. */
+static int parse_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
         const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
         flatcc_json_parser_table_f *parser)
 {
-    flatcc_json_parser_t _ctx;
     flatcc_builder_ref_t root;
     flatcc_builder_buffer_flags_t builder_flags = flags & flatcc_json_parser_f_with_size ? flatcc_builder_with_size : 0;
 
-    ctx = ctx ? ctx : &_ctx;
-    flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
     if (flatcc_builder_start_buffer(B, fid, 0, builder_flags)) return -1;
     buf = parser(ctx, buf, buf + bufsiz, &root);
     if (ctx->error) {
@@ -1276,6 +2138,300 @@ int flatcc_json_parser_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *
     return 0;
 }
 
+int flatcc_json_parser_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser)
+{
+    flatcc_json_parser_t _ctx;
+
+    ctx = ctx ? ctx : &_ctx;
+    flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
+    return parse_table_as_root(B, ctx, buf, bufsiz, flags, fid, parser);
+}
+
+int flatcc_json_parser_table_as_root_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        const flatcc_json_parser_parallel_t *parallel)
+{
+    flatcc_json_parser_t _ctx;
+
+    ctx = ctx ? ctx : &_ctx;
+    flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
+    ctx->parallel = parallel && parallel->run ? parallel : 0;
+    return parse_table_as_root(B, ctx, buf, bufsiz, flags, fid, parser);
+}
+
+static int emit_buffer(flatcc_builder_t *B, flatcc_json_parser_emit_f *emit, void *emit_context)
+{
+    void *data;
+    size_t size;
+    int ret;
+
+    if ((data = flatcc_builder_get_direct_buffer(B, &size))) {
+        return emit(emit_context, data, size);
+    }
+    if (!(data = flatcc_builder_finalize_buffer(B, &size))) {
+        return -1;
+    }
+    ret = emit(emit_context, data, size);
+    flatcc_builder_free(data);
+    return ret;
+}
+
+int flatcc_json_parser_ndjson(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count)
+{
+    flatcc_json_parser_t _ctx;
+    flatcc_json_parser_stats_t stats;
+    const char *end = buf + bufsiz, *next, *p;
+    size_t n = 0;
+    int line = 1, ret = 0;
+
+    ctx = ctx ? ctx : &_ctx;
+    memset(&stats, 0, sizeof(stats));
+    flags |= flatcc_json_parser_f_with_size;
+    for (; buf != end; buf = next, ++line) {
+        if ((next = memchr(buf, '\n', (size_t)(end - buf)))) {
+            ++next;
+        } else {
+            next = end;
+        }
+        for (p = buf; p != next && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'); ++p) {
+        }
+        if (p == next) {
+            continue;
+        }
+        flatcc_json_parser_init(ctx, B, buf, next, flags);
+        ctx->line = line;
+        ctx->stats = stats;
+        ret = parse_table_as_root(B, ctx, buf, (size_t)(next - buf), flags, fid, parser);
+        stats = ctx->stats;
+        if (ret) {
+            break;
+        }
+        /* The root parsers ignore trailing data, but a line holds one table. */
+        for (p = ctx->end_loc; p != next && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'); ++p) {
+        }
+        if (p != next) {
+            flatcc_json_parser_set_error(ctx, p, next, flatcc_json_parser_error_unexpected_character);
+            ret = ctx->error;
+            break;
+        }
+        if (emit && (ret = emit_buffer(B, emit, emit_context))) {
+            break;
+        }
+        ++n;
+        if (flatcc_builder_reset(B)) {
+            ret = -1;
+            break;
+        }
+    }
+    if (count) {
+        *count = n;
+    }
+    return ret;
+}
+
+size_t flatcc_json_parser_ndjson_split(const char *buf, size_t bufsiz,
+        size_t parts, size_t *offsets)
+{
+    const char *p;
+    size_t i, n = 0, k = 0, pos;
+
+    if (parts == 0) {
+        offsets[0] = bufsiz;
+        return 0;
+    }
+    for (i = 1; i < parts && k < bufsiz; ++i) {
+        pos = bufsiz / parts * i;
+        if (pos < k) {
+            continue;
+        }
+        offsets[n++] = k;
+        p = memchr(buf + pos, '\n', bufsiz - pos);
+        k = p ? (size_t)(p - buf) + 1 : bufsiz;
+    }
+    if (k < bufsiz) {
+        offsets[n++] = k;
+    }
+    offsets[n] = bufsiz;
+    return n;
+}
+
+/*
+ * Emitted buffers of an NDJSON range, each stored after its size with
+ * both aligned to `NDJSON_ALIGN` so the buffers are delivered with the
+ * alignment of a malloc'ed buffer as in a serial parse.
+ */
+#define NDJSON_ALIGN 16
+#define NDJSON_PAD(n) (((n) + NDJSON_ALIGN - 1) & ~(size_t)(NDJSON_ALIGN - 1))
+
+typedef struct ndjson_job {
+    const char *buf;
+    size_t bufsiz;
+    flatcc_json_parser_t ctx;
+    int ret;
+    /* Buffers emitted, and newlines in the range. */
+    size_t count;
+    int lines;
+    char *data;
+    size_t size, capacity;
+} ndjson_job_t;
+
+typedef struct ndjson_jobs {
+    flatcc_json_parser_flags_t flags;
+    const char *fid;
+    flatcc_json_parser_table_f *parser;
+    int emit;
+    ndjson_job_t *jobs;
+} ndjson_jobs_t;
+
+static int ndjson_collect(void *emit_context, const void *buf, size_t bufsiz)
+{
+    ndjson_job_t *J = emit_context;
+    size_t n = NDJSON_ALIGN + NDJSON_PAD(bufsiz), k;
+    char *p;
+
+    if (J->size + n > J->capacity) {
+        k = J->capacity ? J->capacity : NDJSON_ALIGN * 64;
+        while (k < J->size + n) {
+            k *= 2;
+        }
+        if (!(p = FLATCC_JSON_PARSER_REALLOC(J->data, k))) {
+            return -1;
+        }
+        J->data = p;
+        J->capacity = k;
+    }
+    memcpy(J->data + J->size, &bufsiz, sizeof(bufsiz));
+    memcpy(J->data + J->size + NDJSON_ALIGN, buf, bufsiz);
+    J->size += n;
+    return 0;
+}
+
+static void parse_ndjson_job(void *job_context, size_t index)
+{
+    ndjson_jobs_t *P = job_context;
+    ndjson_job_t *J = P->jobs + index;
+    flatcc_builder_t builder;
+    const char *p = J->buf, *end = J->buf + J->bufsiz;
+
+    while ((p = memchr(p, '\n', (size_t)(end - p)))) {
+        ++p;
+        ++J->lines;
+    }
+    if (flatcc_builder_init(&builder)) {
+        J->ret = -1;
+        return;
+    }
+    flatcc_json_parser_init(&J->ctx, &builder, J->buf, end, P->flags);
+    J->ret = flatcc_json_parser_ndjson(&builder, &J->ctx, J->buf, J->bufsiz, P->flags, P->fid, P->parser,
+            P->emit ? ndjson_collect : 0, J, &J->count);
+    flatcc_builder_clear(&builder);
+}
+
+int flatcc_json_parser_ndjson_parallel(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser,
+        flatcc_json_parser_emit_f *emit, void *emit_context, size_t *count,
+        const flatcc_json_parser_parallel_t *parallel)
+{
+    flatcc_json_parser_t _ctx;
+    flatcc_json_parser_stats_t stats;
+    ndjson_jobs_t P;
+    ndjson_job_t *J;
+    size_t *offsets = 0;
+    size_t chunk, batch, parts, first, i, k, n = 0, m, size;
+    const char *data;
+    int lines = 0, ret = 0;
+
+    if (!parallel || !parallel->run) {
+        return flatcc_json_parser_ndjson(B, ctx, buf, bufsiz, flags, fid, parser, emit, emit_context, count);
+    }
+    chunk = parallel->chunk_size ? parallel->chunk_size : FLATCC_JSON_PARSER_PARALLEL_CHUNK;
+    batch = parallel->batch_size ? parallel->batch_size : FLATCC_JSON_PARSER_PARALLEL_BATCH;
+    if ((parts = bufsiz / chunk) < 2) {
+        return flatcc_json_parser_ndjson(B, ctx, buf, bufsiz, flags, fid, parser, emit, emit_context, count);
+    }
+    if (!(offsets = FLATCC_JSON_PARSER_ALLOC((parts + 1) * sizeof(size_t)))) {
+        return -1;
+    }
+    if ((parts = flatcc_json_parser_ndjson_split(buf, bufsiz, parts, offsets)) < 2) {
+        FLATCC_JSON_PARSER_FREE(offsets);
+        return flatcc_json_parser_ndjson(B, ctx, buf, bufsiz, flags, fid, parser, emit, emit_context, count);
+    }
+    if (batch > parts) {
+        batch = parts;
+    }
+    if (!(P.jobs = FLATCC_JSON_PARSER_ALLOC(batch * sizeof(ndjson_job_t)))) {
+        FLATCC_JSON_PARSER_FREE(offsets);
+        return -1;
+    }
+    ctx = ctx ? ctx : &_ctx;
+    flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
+    memset(&stats, 0, sizeof(stats));
+    P.flags = flags;
+    P.fid = fid;
+    P.parser = parser;
+    P.emit = emit != 0;
+    /*
+     * Ranges are parsed a batch at a time and their buffers delivered in
+     * range order, so the output is held in memory for one batch only.
+     * Parsing stops in the first range that fails, after the buffers
+     * it emitted before the failing line are delivered.
+     */
+    for (first = 0; first < parts && !ret; first += m) {
+        m = parts - first < batch ? parts - first : batch;
+        memset(P.jobs, 0, m * sizeof(ndjson_job_t));
+        for (i = 0; i < m; ++i) {
+            P.jobs[i].buf = buf + offsets[first + i];
+            P.jobs[i].bufsiz = offsets[first + i + 1] - offsets[first + i];
+        }
+        parallel->run(parallel->run_context, parse_ndjson_job, &P, m);
+        for (i = 0; i < m; ++i) {
+            J = P.jobs + i;
+            if (ret) {
+                goto next;
+            }
+            for (k = 0, data = J->data; k < J->count && emit; ++k) {
+                memcpy(&size, data, sizeof(size));
+                if ((ret = emit(emit_context, data + NDJSON_ALIGN, size))) {
+                    goto next;
+                }
+                data += NDJSON_ALIGN + NDJSON_PAD(size);
+                ++n;
+            }
+            if (!emit) {
+                n += J->count;
+            }
+            stats.strings += J->ctx.stats.strings;
+            stats.direct_strings += J->ctx.stats.direct_strings;
+            stats.union_reparses += J->ctx.stats.union_reparses;
+            if (J->count || J->ret) {
+                *ctx = J->ctx;
+                ctx->ctx = B;
+                ctx->line += lines;
+            }
+            lines += J->lines;
+            ret = J->ret;
+next:
+            if (J->data) {
+                FLATCC_JSON_PARSER_FREE(J->data);
+            }
+        }
+    }
+    ctx->stats = stats;
+    FLATCC_JSON_PARSER_FREE(P.jobs);
+    FLATCC_JSON_PARSER_FREE(offsets);
+    if (count) {
+        *count = n;
+    }
+    return ret;
+}
+
 int flatcc_json_parser_struct_as_root(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
         const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
         flatcc_json_parser_table_f *parser)
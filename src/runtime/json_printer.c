@@ -9,6 +9,16 @@
 #include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/flatcc_assert.h"
 
+/* File descriptor output for `flatcc_json_printer_init_fd`. */
+#if defined(_WIN32)
+#include <io.h>
+#define HAS_FD_WRITE
+#elif defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#include <errno.h>
+#define HAS_FD_WRITE
+#endif
+
 /*
  * Grisu significantly improves printing speed of floating point values
  * and also the overall printing speed when floating point values are
@@ -17,6 +27,9 @@
 #if FLATCC_USE_GRISU3 && !defined(PORTABLE_USE_GRISU3)
 #define PORTABLE_USE_GRISU3 1
 #endif
+#if !defined(PORTABLE_USE_SCHUBFACH)
+#define PORTABLE_USE_SCHUBFACH FLATCC_USE_SCHUBFACH
+#endif
 
 #include "flatcc/flatcc_flatbuffers.h"
 #include "flatcc/flatcc_json_printer.h"
@@ -24,8 +37,21 @@
 
 #include "flatcc/portable/pprintint.h"
 #include "flatcc/portable/pprintfp.h"
+#if !defined(PORTABLE_BASE64_SIMD)
+#define PORTABLE_BASE64_SIMD (FLATCC_USE_SSE2 && FLATCC_USE_AVX2)
+#endif
 #include "flatcc/portable/pbase64.h"
 
+#if FLATCC_USE_SSE2
+#include "flatcc/portable/psimd.h"
+#ifdef PORTABLE_SSE2
+#define USE_SSE2
+#if FLATCC_USE_AVX2 && defined(PORTABLE_AVX2)
+#define USE_AVX2
+#endif
+#endif
+#endif
+
 
 #define RAISE_ERROR(err) flatcc_json_printer_set_error(ctx, flatcc_json_printer_error_##err)
 
@@ -77,7 +103,20 @@ static inline voffset_t read_voffset(const void *p, uoffset_t base)
     return __flatbuffers_voffset_read_from_pe((uint8_t *)p + base);
 }
 
-static inline const void *get_field_ptr(flatcc_json_printer_table_descriptor_t *td, int id)
+static inline int is_selected(const flatcc_json_printer_projection_t *projection, int id)
+{
+    return (size_t)id < projection->size && ((projection->fields[id >> 3] >> (id & 7)) & 1);
+}
+
+/* Projection of the table held by a selected field, or null for all fields. */
+static inline const flatcc_json_printer_projection_t *get_child_projection(
+        flatcc_json_printer_table_descriptor_t *td, int id)
+{
+    return td->projection ? td->projection->children[id] : 0;
+}
+
+/* Ignores the projection, e.g. for the type field of a selected union. */
+static inline const void *get_any_field_ptr(flatcc_json_printer_table_descriptor_t *td, int id)
 {
     uoffset_t vo = (uoffset_t)(id + 2) * (uoffset_t)sizeof(voffset_t);
 
@@ -91,6 +130,15 @@ static inline const void *get_field_ptr(flatcc_json_printer_table_descriptor_t *
     return (uint8_t *)td->table + vo;
 }
 
+/* Unselected fields are treated as absent. */
+static inline const void *get_field_ptr(flatcc_json_printer_table_descriptor_t *td, int id)
+{
+    if (td->projection && !is_selected(td->projection, id)) {
+        return 0;
+    }
+    return get_any_field_ptr(td, id);
+}
+
 #define print_char(c) *ctx->p++ = (c)
 
 #define print_null() do {                                                   \
@@ -194,6 +242,53 @@ static inline void print(flatcc_json_printer_t *ctx, const char *s, size_t n)
     }
 }
 
+/*
+ * Strings are copied in runs that end at the next byte that must be
+ * escaped: '"', '\\', or a control character < 0x20. These are the
+ * bytes that also end string content in the JSON parser, so both use
+ * the string run kernels of psimd.h. A kernel skips whole blocks
+ * without such a byte and returns at the block holding one, or when
+ * less than a block remains, leaving the rest to the scalar loop of
+ * the caller.
+ */
+#ifdef USE_SSE2
+
+static inline const char *escape_run(const char *p, const char *end)
+{
+#ifdef USE_AVX2
+    if (end - p >= 32 && portable_cpu_has_avx2()) {
+        return portable_avx2_string_run(p, end);
+    }
+#endif
+    return portable_sse2_string_run(p, end);
+}
+
+#else /* USE_SSE2 */
+
+/*
+ * Without SSE2, 8 bytes are tested at a time using the zero byte test
+ * `(x - 0x01..) & ~x & 0x80..`. It may misreport bytes after a match,
+ * so the scalar loop locates the byte.
+ */
+static inline const char *escape_run(const char *p, const char *end)
+{
+    const uint64_t ones = UINT64_C(0x0101010101010101), high = ones << 7;
+    uint64_t x, q, e;
+
+    while (end - p >= 8) {
+        memcpy(&x, p, 8);
+        q = x ^ (ones * '\"');
+        e = x ^ (ones * '\\');
+        if (((x - ones * 0x20) & ~x & high) | ((q - ones) & ~q & high) | ((e - ones) & ~e & high)) {
+            break;
+        }
+        p += 8;
+    }
+    return p;
+}
+
+#endif /* USE_SSE2 */
+
 static void print_escape(flatcc_json_printer_t *ctx, unsigned char c)
 {
     unsigned char x;
@@ -234,13 +329,14 @@ static void print_escape(flatcc_json_printer_t *ctx, unsigned char c)
  */
 static void print_string(flatcc_json_printer_t *ctx, const char *s, size_t n)
 {
-    const char *p = s;
+    const char *p = s, *end = s + n;
     /* Unsigned is important. */
     unsigned char c;
     size_t k;
 
     print_char('\"');
     for (;;) {
+        p = escape_run(p, end);
         c = (unsigned char)*p;
         while (c >= 0x20 && c != '\"' && c != '\\') {
             c = (unsigned char)*++p;
@@ -274,6 +370,9 @@ static void print_char_array(flatcc_json_printer_t *ctx, const char *s, size_t n
 
     print_char('\"');
     for (;;) {
+        k = (size_t)(escape_run(p, p + n) - p);
+        p += k;
+        n -= k;
         while (n) {
             c = (unsigned char)*p;
             if (c < 0x20 || c == '\"' || c == '\\') break;
@@ -310,10 +409,20 @@ static void print_uint8_vector_base64_object(flatcc_json_printer_t *ctx, const v
         ctx->flush(ctx, 0);
     }
     while (ctx->p + len > ctx->pflush) {
-        /* Multiples of 4 output chars consumes exactly 3 bytes before final padding. */
-        k = (size_t)(ctx->pflush - ctx->p) & ~(size_t)3;
+        /*
+         * Multiples of 4 output chars consumes exactly 3 bytes before final padding.
+         * Rounding up ends at most 3 chars into the reserve, so the flush
+         * always makes room, also for dynamic buffers that only grow when full.
+         */
+        k = ((size_t)(ctx->pflush - ctx->p) + 3) & ~(size_t)3;
+        if (k > data_len / 3 * 4) {
+            k = data_len / 3 * 4;
+        }
+        if (k == 0) {
+            /* At most 4 chars remain and they fit in the reserve. */
+            break;
+        }
         n = k * 3 / 4;
-        FLATCC_ASSERT(n > 0);
         src_len = k * 3 / 4;
         base64_encode((uint8_t *)ctx->p, data, 0, &src_len, unpadded_mode);
         ctx->p += k;
@@ -594,12 +703,11 @@ void flatcc_json_printer_ ## TN ## _enum_struct_field(                      \
 }
 
 #define __define_print_scalar_field(TN, T)                                  \
-void flatcc_json_printer_ ## TN ## _field(flatcc_json_printer_t *ctx,       \
+static void print_ ## TN ## _field(flatcc_json_printer_t *ctx,              \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len, T v)                          \
+        int id, const void *p, const char *name, size_t len, T v)           \
 {                                                                           \
     T x;                                                                    \
-    const void *p = get_field_ptr(td, id);                                  \
                                                                             \
     if (p) {                                                                \
         x = flatbuffers_ ## TN ## _read_from_pe(p);                         \
@@ -607,7 +715,8 @@ void flatcc_json_printer_ ## TN ## _field(flatcc_json_printer_t *ctx,       \
             return;                                                         \
         }                                                                   \
     } else {                                                                \
-        if (!ctx->force_default) {                                          \
+        if (!ctx->force_default ||                                          \
+                (td->projection && !is_selected(td->projection, id))) {     \
             return;                                                         \
         }                                                                   \
         x = v;                                                              \
@@ -617,16 +726,22 @@ void flatcc_json_printer_ ## TN ## _field(flatcc_json_printer_t *ctx,       \
     }                                                                       \
     print_name(ctx, name, len);                                             \
     ctx->p += print_ ## TN (x, ctx->p);                                     \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _field(flatcc_json_printer_t *ctx,       \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len, T v)                          \
+{                                                                           \
+    print_ ## TN ## _field(ctx, td, id, get_field_ptr(td, id),              \
+            name, len, v);                                                  \
 }
 
 #define __define_print_scalar_optional_field(TN, T)                         \
-void flatcc_json_printer_ ## TN ## _optional_field(                         \
-        flatcc_json_printer_t *ctx,                                         \
+static void print_ ## TN ## _optional_field(flatcc_json_printer_t *ctx,     \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len)                               \
+        const void *p, const char *name, size_t len)                        \
 {                                                                           \
     T x;                                                                    \
-    const void *p = get_field_ptr(td, id);                                  \
                                                                             \
     if (!p) return;                                                         \
     x = flatbuffers_ ## TN ## _read_from_pe(p);                             \
@@ -635,17 +750,25 @@ void flatcc_json_printer_ ## TN ## _optional_field(                         \
     }                                                                       \
     print_name(ctx, name, len);                                             \
     ctx->p += print_ ## TN (x, ctx->p);                                     \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _optional_field(                         \
+        flatcc_json_printer_t *ctx,                                         \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len)                               \
+{                                                                           \
+    print_ ## TN ## _optional_field(ctx, td, get_field_ptr(td, id),         \
+            name, len);                                                     \
 }
 
 
 #define __define_print_enum_field(TN, T)                                    \
-void flatcc_json_printer_ ## TN ## _enum_field(flatcc_json_printer_t *ctx,  \
+static void print_ ## TN ## _enum_field(flatcc_json_printer_t *ctx,         \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len, T v,                          \
+        int id, const void *p, const char *name, size_t len, T v,           \
         flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
 {                                                                           \
     T x;                                                                    \
-    const void *p = get_field_ptr(td, id);                                  \
                                                                             \
     if (p) {                                                                \
         x = flatbuffers_ ## TN ## _read_from_pe(p);                         \
@@ -653,7 +776,8 @@ void flatcc_json_printer_ ## TN ## _enum_field(flatcc_json_printer_t *ctx,  \
             return;                                                         \
         }                                                                   \
     } else {                                                                \
-        if (!ctx->force_default) {                                          \
+        if (!ctx->force_default ||                                          \
+                (td->projection && !is_selected(td->projection, id))) {     \
             return;                                                         \
         }                                                                   \
         x = v;                                                              \
@@ -667,17 +791,25 @@ void flatcc_json_printer_ ## TN ## _enum_field(flatcc_json_printer_t *ctx,  \
     } else {                                                                \
         pf(ctx, x);                                                         \
     }                                                                       \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _enum_field(flatcc_json_printer_t *ctx,  \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len, T v,                          \
+        flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
+{                                                                           \
+    print_ ## TN ## _enum_field(ctx, td, id, get_field_ptr(td, id),         \
+            name, len, v, pf);                                              \
 }
 
 #define __define_print_enum_optional_field(TN, T)                           \
-void flatcc_json_printer_ ## TN ## _enum_optional_field(                    \
+static void print_ ## TN ## _enum_optional_field(                           \
         flatcc_json_printer_t *ctx,                                         \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len,                               \
+        const void *p, const char *name, size_t len,                        \
         flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
 {                                                                           \
     T x;                                                                    \
-    const void *p = get_field_ptr(td, id);                                  \
                                                                             \
     if (!p) return;                                                         \
     x = flatbuffers_ ## TN ## _read_from_pe(p);                             \
@@ -690,10 +822,21 @@ void flatcc_json_printer_ ## TN ## _enum_optional_field(                    \
     } else {                                                                \
         pf(ctx, x);                                                         \
     }                                                                       \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _enum_optional_field(                    \
+        flatcc_json_printer_t *ctx,                                         \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len,                               \
+        flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
+{                                                                           \
+    print_ ## TN ## _enum_optional_field(ctx, td, get_field_ptr(td, id),    \
+            name, len, pf);                                                 \
 }
 
 static inline void print_table_object(flatcc_json_printer_t *ctx,
-        const void *p, int ttl, flatcc_json_printer_table_f pf)
+        const void *p, int ttl, flatcc_json_printer_table_f pf,
+        const flatcc_json_printer_projection_t *projection)
 {
     flatcc_json_printer_table_descriptor_t td;
 
@@ -704,6 +847,7 @@ static inline void print_table_object(flatcc_json_printer_t *ctx,
     print_start('{');
     td.count = 0;
     td.ttl = ttl;
+    td.projection = projection;
     td.table = p;
     td.vtable = (uint8_t *)p - __flatbuffers_soffset_read_from_pe(p);
     td.vsize = __flatbuffers_voffset_read_from_pe(td.vtable);
@@ -711,12 +855,10 @@ static inline void print_table_object(flatcc_json_printer_t *ctx,
     print_end('}');
 }
 
-void flatcc_json_printer_string_field(flatcc_json_printer_t *ctx,
+static void print_string_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len)
+        const void *p, const char *name, size_t len)
 {
-    const void *p = get_field_ptr(td, id);
-
     if (p) {
         if (td->count++) {
             print_char(',');
@@ -726,11 +868,17 @@ void flatcc_json_printer_string_field(flatcc_json_printer_t *ctx,
     }
 }
 
-void flatcc_json_printer_uint8_vector_base64_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_string_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len, int urlsafe)
+        int id, const char *name, size_t len)
+{
+    print_string_field(ctx, td, get_field_ptr(td, id), name, len);
+}
+
+static void print_uint8_vector_base64_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        const void *p, const char *name, size_t len, int urlsafe)
 {
-    const void *p = get_field_ptr(td, id);
     int mode;
 
     mode = urlsafe ? base64_mode_url : base64_mode_rfc4648;
@@ -745,13 +893,18 @@ void flatcc_json_printer_uint8_vector_base64_field(flatcc_json_printer_t *ctx,
     }
 }
 
+void flatcc_json_printer_uint8_vector_base64_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const char *name, size_t len, int urlsafe)
+{
+    print_uint8_vector_base64_field(ctx, td, get_field_ptr(td, id), name, len, urlsafe);
+}
+
 #define __define_print_scalar_vector_field(TN, T)                           \
-void flatcc_json_printer_ ## TN ## _vector_field(                           \
-        flatcc_json_printer_t *ctx,                                         \
+static void print_ ## TN ## _vector_field(flatcc_json_printer_t *ctx,       \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len)                               \
+        const void *p, const char *name, size_t len)                        \
 {                                                                           \
-    const void *p = get_field_ptr(td, id);                                  \
     uoffset_t count;                                                        \
                                                                             \
     if (p) {                                                                \
@@ -781,23 +934,29 @@ void flatcc_json_printer_ ## TN ## _vector_field(                           \
         }                                                                   \
         print_end(']');                                                     \
     }                                                                       \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _vector_field(                           \
+        flatcc_json_printer_t *ctx,                                         \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len)                               \
+{                                                                           \
+    print_ ## TN ## _vector_field(ctx, td, get_field_ptr(td, id),           \
+            name, len);                                                     \
 }
 
 #define __define_print_enum_vector_field(TN, T)                             \
-void flatcc_json_printer_ ## TN ## _enum_vector_field(                      \
-        flatcc_json_printer_t *ctx,                                         \
+static void print_ ## TN ## _enum_vector_field(flatcc_json_printer_t *ctx,  \
         flatcc_json_printer_table_descriptor_t *td,                         \
-        int id, const char *name, size_t len,                               \
+        const void *p, const char *name, size_t len,                        \
         flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
 {                                                                           \
-    const void *p;                                                          \
     uoffset_t count;                                                        \
                                                                             \
     if (ctx->noenum) {                                                      \
-        flatcc_json_printer_ ## TN ## _vector_field(ctx, td, id, name, len);\
+        print_ ## TN ## _vector_field(ctx, td, p, name, len);               \
         return;                                                             \
     }                                                                       \
-    p = get_field_ptr(td, id);                                              \
     if (p) {                                                                \
         if (td->count++) {                                                  \
             print_char(',');                                                \
@@ -821,6 +980,16 @@ void flatcc_json_printer_ ## TN ## _enum_vector_field(                      \
         }                                                                   \
         print_end(']');                                                     \
     }                                                                       \
+}                                                                           \
+                                                                            \
+void flatcc_json_printer_ ## TN ## _enum_vector_field(                      \
+        flatcc_json_printer_t *ctx,                                         \
+        flatcc_json_printer_table_descriptor_t *td,                         \
+        int id, const char *name, size_t len,                               \
+        flatcc_json_printer_ ## TN ##_enum_f *pf)                           \
+{                                                                           \
+    print_ ## TN ## _enum_vector_field(ctx, td, get_field_ptr(td, id),      \
+            name, len, pf);                                                 \
 }
 
 __define_print_scalar_field(uint8, uint8_t)
@@ -935,13 +1104,12 @@ __define_print_enum_vector_field(int32, int32_t)
 __define_print_enum_vector_field(int64, int64_t)
 __define_print_enum_vector_field(bool, flatbuffers_bool_t)
 
-void flatcc_json_printer_struct_vector_field(flatcc_json_printer_t *ctx,
+static void print_struct_vector_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len,
+        const uint8_t *p, const char *name, size_t len,
         size_t size,
         flatcc_json_printer_struct_f pf)
 {
-    const uint8_t *p = get_field_ptr(td, id);
     uoffset_t count;
 
     if (p) {
@@ -972,11 +1140,19 @@ void flatcc_json_printer_struct_vector_field(flatcc_json_printer_t *ctx,
     }
 }
 
-void flatcc_json_printer_string_vector_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_struct_vector_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len)
+        int id, const char *name, size_t len,
+        size_t size,
+        flatcc_json_printer_struct_f pf)
+{
+    print_struct_vector_field(ctx, td, get_field_ptr(td, id), name, len, size, pf);
+}
+
+static void print_string_vector_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        const uoffset_t *p, const char *name, size_t len)
 {
-    const uoffset_t *p = get_field_ptr(td, id);
     uoffset_t count;
 
     if (p) {
@@ -1003,13 +1179,140 @@ void flatcc_json_printer_string_vector_field(flatcc_json_printer_t *ctx,
     }
 }
 
-void flatcc_json_printer_table_vector_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_string_vector_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len,
-        flatcc_json_printer_table_f pf)
+        int id, const char *name, size_t len)
 {
-    const uoffset_t *p = get_field_ptr(td, id);
+    print_string_vector_field(ctx, td, get_field_ptr(td, id), name, len);
+}
+
+/* A range of table vector elements printed into a buffer of its own. */
+typedef struct parallel_job {
+    const uoffset_t *p;
     uoffset_t count;
+    char *buf;
+    size_t size;
+    int error;
+} parallel_job_t;
+
+typedef struct parallel_tables {
+    flatcc_json_printer_t *ctx;
+    flatcc_json_printer_table_f *pf;
+    int ttl;
+    const flatcc_json_printer_projection_t *projection;
+    /* Jobs of the current batch, and the vector index of the first. */
+    parallel_job_t *jobs;
+    size_t first;
+} parallel_tables_t;
+
+/*
+ * Every range but the first starts with the comma separating it from
+ * the previous range, so the buffers can be written back to back.
+ */
+static void print_parallel_job(void *job_context, size_t index)
+{
+    parallel_tables_t *P = job_context;
+    parallel_job_t *J = P->jobs + index;
+    flatcc_json_printer_t printer, *ctx = &printer;
+    const uoffset_t *p = J->p;
+    uoffset_t count = J->count;
+
+    J->error = -1;
+    if (flatcc_json_printer_init_dynamic_buffer(ctx, 0)) {
+        return;
+    }
+    ctx->indent = P->ctx->indent;
+    ctx->unquote = P->ctx->unquote;
+    ctx->noenum = P->ctx->noenum;
+    ctx->skip_default = P->ctx->skip_default;
+    ctx->force_default = P->ctx->force_default;
+    ctx->level = P->ctx->level;
+    if (P->first + index) {
+        print_char(',');
+    }
+    print_table_object(ctx, read_uoffset_ptr(p), P->ttl, P->pf, P->projection);
+    while (--count) {
+        ++p;
+        print_char(',');
+        print_table_object(ctx, read_uoffset_ptr(p), P->ttl, P->pf, P->projection);
+    }
+    if (ctx->error) {
+        flatcc_json_printer_clear(ctx);
+        return;
+    }
+    J->buf = ctx->buf;
+    J->size = (size_t)(ctx->p - ctx->buf);
+    J->error = 0;
+}
+
+/*
+ * Jobs are run in batches of `batch_size`, and each batch is written
+ * and freed before the next starts, so only the text of one batch is
+ * held in memory. Returns the number of elements printed, which is 0
+ * if the vector is too small to split. When a job fails, the remaining
+ * elements from the start of its batch are left to the caller to print
+ * serially.
+ */
+static uoffset_t print_parallel_tables(flatcc_json_printer_t *ctx,
+        const uoffset_t *p, uoffset_t count, int ttl, flatcc_json_printer_table_f pf,
+        const flatcc_json_printer_projection_t *projection)
+{
+    const flatcc_json_printer_parallel_t *parallel = ctx->parallel;
+    size_t chunk = parallel->chunk_size ? parallel->chunk_size : FLATCC_JSON_PRINT_PARALLEL_CHUNK;
+    size_t batch = parallel->batch_size ? parallel->batch_size : FLATCC_JSON_PRINT_PARALLEL_BATCH;
+    parallel_tables_t P;
+    size_t i, n, k, total;
+    int failed = 0;
+
+    if (count / 2 < chunk) {
+        return 0;
+    }
+    total = (count + chunk - 1) / chunk;
+    if (batch > total) {
+        batch = total;
+    }
+    if (!(P.jobs = FLATCC_JSON_PRINTER_ALLOC(batch * sizeof(parallel_job_t)))) {
+        return 0;
+    }
+    P.ctx = ctx;
+    P.pf = pf;
+    P.ttl = ttl;
+    P.projection = projection;
+    for (P.first = 0; P.first < total && !failed && !ctx->error; P.first += n) {
+        n = total - P.first < batch ? total - P.first : batch;
+        memset(P.jobs, 0, n * sizeof(parallel_job_t));
+        for (i = 0; i < n; ++i) {
+            k = P.first + i;
+            P.jobs[i].p = p + k * chunk;
+            P.jobs[i].count = (uoffset_t)(k + 1 < total ? chunk : count - k * chunk);
+        }
+        parallel->run(parallel->run_context, print_parallel_job, &P, n);
+        for (i = 0; i < n; ++i) {
+            failed |= P.jobs[i].error;
+        }
+        for (i = 0; i < n; ++i) {
+            if (!failed) {
+                print(ctx, P.jobs[i].buf, P.jobs[i].size);
+            }
+            if (P.jobs[i].buf) {
+                FLATCC_JSON_PRINTER_FREE(P.jobs[i].buf);
+            }
+        }
+        if (failed) {
+            break;
+        }
+    }
+    FLATCC_JSON_PRINTER_FREE(P.jobs);
+    return P.first < total ? (uoffset_t)(P.first * chunk) : count;
+}
+
+static void print_table_vector_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const uoffset_t *p, const char *name, size_t len,
+        flatcc_json_printer_table_f pf)
+{
+    const flatcc_json_printer_projection_t *projection;
+    uoffset_t i, count;
 
     if (p) {
         if (td->count++) {
@@ -1018,29 +1321,35 @@ void flatcc_json_printer_table_vector_field(flatcc_json_printer_t *ctx,
         p = read_uoffset_ptr(p);
         count = __flatbuffers_uoffset_read_from_pe(p);
         ++p;
+        projection = get_child_projection(td, id);
         print_name(ctx, name, len);
         print_start('[');
-        if (count) {
-            print_table_object(ctx, read_uoffset_ptr(p), td->ttl, pf);
-            --count;
-        }
-        while (count--) {
-            ++p;
-            print_char(',');
-            print_table_object(ctx, read_uoffset_ptr(p), td->ttl, pf);
+        i = ctx->parallel ? print_parallel_tables(ctx, p, count, td->ttl, pf, projection) : 0;
+        for (; i < count; ++i) {
+            if (i) {
+                print_char(',');
+            }
+            print_table_object(ctx, read_uoffset_ptr(p + i), td->ttl, pf, projection);
         }
         print_end(']');
     }
 }
 
-void flatcc_json_printer_union_vector_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_table_vector_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
         int id, const char *name, size_t len,
+        flatcc_json_printer_table_f pf)
+{
+    print_table_vector_field(ctx, td, id, get_field_ptr(td, id), name, len, pf);
+}
+
+static void print_union_vector_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const uoffset_t *p, const char *name, size_t len,
         flatcc_json_printer_union_type_f ptf,
         flatcc_json_printer_union_f pf)
 {
-    const uoffset_t *pt = get_field_ptr(td, id - 1);
-    const uoffset_t *p = get_field_ptr(td, id);
+    const uoffset_t *pt = p ? get_any_field_ptr(td, id - 1) : 0;
     utype_t *types, type;
     uoffset_t count;
     char type_name[FLATCC_JSON_PRINT_NAME_LEN_MAX + 5];
@@ -1055,8 +1364,9 @@ void flatcc_json_printer_union_vector_field(flatcc_json_printer_t *ctx,
     memcpy(type_name, name, len);
     memcpy(type_name + len, "_type", 5);
     if (p && pt) {
-        flatcc_json_printer_utype_enum_vector_field(ctx, td, id - 1,
-                type_name, len + 5, ptf);
+        /* The type vector is printed with the selected union. */
+        print_utype_enum_vector_field(ctx, td, pt, type_name, len + 5, ptf);
+        ud.projection = get_child_projection(td, id);
         if (td->count++) {
             print_char(',');
         }
@@ -1097,30 +1407,44 @@ void flatcc_json_printer_union_vector_field(flatcc_json_printer_t *ctx,
     }
 }
 
-void flatcc_json_printer_table_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_union_vector_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
         int id, const char *name, size_t len,
-        flatcc_json_printer_table_f pf)
+        flatcc_json_printer_union_type_f ptf,
+        flatcc_json_printer_union_f pf)
 {
-    const void *p = get_field_ptr(td, id);
+    print_union_vector_field(ctx, td, id, get_field_ptr(td, id), name, len, ptf, pf);
+}
 
+static void print_table_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const void *p, const char *name, size_t len,
+        flatcc_json_printer_table_f pf)
+{
     if (p) {
         if (td->count++) {
             print_char(',');
         }
         print_name(ctx, name, len);
-        print_table_object(ctx, read_uoffset_ptr(p), td->ttl, pf);
+        print_table_object(ctx, read_uoffset_ptr(p), td->ttl, pf, get_child_projection(td, id));
     }
 }
 
-void flatcc_json_printer_union_field(flatcc_json_printer_t *ctx,
+void flatcc_json_printer_table_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
         int id, const char *name, size_t len,
+        flatcc_json_printer_table_f pf)
+{
+    print_table_field(ctx, td, id, get_field_ptr(td, id), name, len, pf);
+}
+
+static void print_union_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const void *p, const char *name, size_t len,
         flatcc_json_printer_union_type_f ptf,
         flatcc_json_printer_union_f pf)
 {
-    const void *pt = get_field_ptr(td, id - 1);
-    const void *p = get_field_ptr(td, id);
+    const void *pt = p ? get_any_field_ptr(td, id - 1) : 0;
     utype_t type;
     flatcc_json_printer_union_descriptor_t ud;
 
@@ -1156,15 +1480,25 @@ void flatcc_json_printer_union_field(flatcc_json_printer_t *ctx,
         ud.ttl = td->ttl;
         ud.type = type;
         ud.member = p;
+        ud.projection = get_child_projection(td, id);
         pf(ctx, &ud);
     }
 }
 
+void flatcc_json_printer_union_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const char *name, size_t len,
+        flatcc_json_printer_union_type_f ptf,
+        flatcc_json_printer_union_f pf)
+{
+    print_union_field(ctx, td, id, get_field_ptr(td, id), name, len, ptf, pf);
+}
+
 void flatcc_json_printer_union_table(flatcc_json_printer_t *ctx,
         flatcc_json_printer_union_descriptor_t *ud,
         flatcc_json_printer_table_f pf)
 {
-    print_table_object(ctx, read_uoffset_ptr(ud->member), ud->ttl, pf);
+    print_table_object(ctx, read_uoffset_ptr(ud->member), ud->ttl, pf, ud->projection);
 }
 
 void flatcc_json_printer_union_struct(flatcc_json_printer_t *ctx,
@@ -1219,13 +1553,11 @@ void flatcc_json_printer_embedded_struct_array_field(flatcc_json_printer_t *ctx,
     print_end(']');
 }
 
-void flatcc_json_printer_struct_field(flatcc_json_printer_t *ctx,
+static void print_struct_field(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
-        int id, const char *name, size_t len,
+        const void *p, const char *name, size_t len,
         flatcc_json_printer_struct_f *pf)
 {
-    const void *p = get_field_ptr(td, id);
-
     if (p) {
         if (td->count++) {
             print_char(',');
@@ -1237,6 +1569,237 @@ void flatcc_json_printer_struct_field(flatcc_json_printer_t *ctx,
     }
 }
 
+void flatcc_json_printer_struct_field(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const char *name, size_t len,
+        flatcc_json_printer_struct_f *pf)
+{
+    print_struct_field(ctx, td, get_field_ptr(td, id), name, len, pf);
+}
+
+static int accept_header(flatcc_json_printer_t * ctx,
+        const void *buf, size_t bufsiz, const char *fid);
+
+static void print_struct_as_nested_root(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        const uoffset_t *buf, const char *name, size_t len,
+        const char *fid,
+        flatcc_json_printer_struct_f *pf)
+{
+    uoffset_t bufsiz;
+
+    if (0 == buf) {
+        return;
+    }
+    buf = (const uoffset_t *)((size_t)buf + __flatbuffers_uoffset_read_from_pe(buf));
+    bufsiz = __flatbuffers_uoffset_read_from_pe(buf);
+    if (!accept_header(ctx, buf, bufsiz, fid)) {
+        return;
+    }
+    if (td->count++) {
+        print_char(',');
+    }
+    print_name(ctx, name, len);
+    print_start('{');
+    pf(ctx, read_uoffset_ptr(buf));
+    print_end('}');
+}
+
+static void print_table_as_nested_root(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        int id, const uoffset_t *buf, const char *name, size_t len,
+        const char *fid,
+        flatcc_json_printer_table_f pf)
+{
+    uoffset_t bufsiz;
+
+    if (0 == buf) {
+        return;
+    }
+    buf = (const uoffset_t *)((size_t)buf + __flatbuffers_uoffset_read_from_pe(buf));
+    bufsiz = __flatbuffers_uoffset_read_from_pe(buf);
+    ++buf;
+    if (!accept_header(ctx, buf, bufsiz, fid)) {
+        return;
+    }
+    if (td->count++) {
+        print_char(',');
+    }
+    print_name(ctx, name, len);
+    print_table_object(ctx, read_uoffset_ptr(buf), td->ttl, pf, get_child_projection(td, id));
+}
+
+#define __define_field_default(TN, T)                                       \
+static inline T TN ## _field_default(const flatcc_json_printer_field_t *f)  \
+{                                                                           \
+    return (T)f->value;                                                     \
+}
+
+__define_field_default(uint8, uint8_t)
+__define_field_default(uint16, uint16_t)
+__define_field_default(uint32, uint32_t)
+__define_field_default(uint64, uint64_t)
+__define_field_default(int8, int8_t)
+__define_field_default(int16, int16_t)
+__define_field_default(int32, int32_t)
+__define_field_default(int64, int64_t)
+__define_field_default(bool, flatbuffers_bool_t)
+
+static inline float float_field_default(const flatcc_json_printer_field_t *f)
+{
+    uint32_t u = (uint32_t)f->value;
+    float x;
+
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+static inline double double_field_default(const flatcc_json_printer_field_t *f)
+{
+    double x;
+
+    memcpy(&x, &f->value, sizeof(x));
+    return x;
+}
+
+#define __field_case(TN, CALL) case flatcc_json_printer_type_ ## TN: CALL(TN); break;
+
+#define __integral_field_cases(CALL)                                        \
+    __field_case(uint8, CALL)                                               \
+    __field_case(uint16, CALL)                                              \
+    __field_case(uint32, CALL)                                              \
+    __field_case(uint64, CALL)                                              \
+    __field_case(int8, CALL)                                                \
+    __field_case(int16, CALL)                                               \
+    __field_case(int32, CALL)                                               \
+    __field_case(int64, CALL)                                               \
+    __field_case(bool, CALL)
+
+#define __scalar_field_cases(CALL)                                          \
+    __integral_field_cases(CALL)                                            \
+    __field_case(float, CALL)                                               \
+    __field_case(double, CALL)
+
+#define __call_scalar_field(TN)                                             \
+    print_ ## TN ## _field(ctx, td, f->id, p, f->name, f->len,              \
+            TN ## _field_default(f))
+
+#define __call_optional_field(TN)                                           \
+    print_ ## TN ## _optional_field(ctx, td, p, f->name, f->len)
+
+#define __call_enum_field(TN)                                               \
+    print_ ## TN ## _enum_field(ctx, td, f->id, p, f->name, f->len,         \
+            TN ## _field_default(f),                                        \
+            (flatcc_json_printer_ ## TN ## _enum_f *)f->pf)
+
+#define __call_enum_optional_field(TN)                                      \
+    print_ ## TN ## _enum_optional_field(ctx, td, p, f->name, f->len,       \
+            (flatcc_json_printer_ ## TN ## _enum_f *)f->pf)
+
+#define __call_vector_field(TN)                                             \
+    print_ ## TN ## _vector_field(ctx, td, p, f->name, f->len)
+
+#define __call_enum_vector_field(TN)                                        \
+    print_ ## TN ## _enum_vector_field(ctx, td, p, f->name, f->len,         \
+            (flatcc_json_printer_ ## TN ## _enum_f *)f->pf)
+
+/*
+ * Each field is looked up once here and the pointer is passed to the
+ * same static functions that the public per-field functions wrap.
+ */
+void flatcc_json_printer_table_fields(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_table_descriptor_t *td,
+        const flatcc_json_printer_field_t *fields, size_t count)
+{
+    const flatcc_json_printer_field_t *f, *end = fields + count;
+    flatcc_json_printer_union_type_f *ptf = 0;
+    const void *p;
+
+    for (f = fields; f != end; ++f) {
+        if (f->kind == flatcc_json_printer_kind_union_type) {
+            ptf = (flatcc_json_printer_union_type_f *)f->pf;
+            continue;
+        }
+        /*
+         * Scalars may have to print their default when absent. Anything
+         * else is skipped here without a call when absent or not
+         * selected.
+         */
+        if (!(p = get_field_ptr(td, f->id)) && !(ctx->force_default &&
+                (f->kind == flatcc_json_printer_kind_scalar ||
+                f->kind == flatcc_json_printer_kind_enum))) {
+            continue;
+        }
+        switch (f->kind) {
+        case flatcc_json_printer_kind_scalar:
+            switch (f->type) { __scalar_field_cases(__call_scalar_field) }
+            break;
+        case flatcc_json_printer_kind_optional:
+            switch (f->type) { __scalar_field_cases(__call_optional_field) }
+            break;
+        case flatcc_json_printer_kind_enum:
+            switch (f->type) { __integral_field_cases(__call_enum_field) }
+            break;
+        case flatcc_json_printer_kind_enum_optional:
+            switch (f->type) { __integral_field_cases(__call_enum_optional_field) }
+            break;
+        case flatcc_json_printer_kind_vector:
+            switch (f->type) { __scalar_field_cases(__call_vector_field) }
+            break;
+        case flatcc_json_printer_kind_enum_vector:
+            switch (f->type) { __integral_field_cases(__call_enum_vector_field) }
+            break;
+        case flatcc_json_printer_kind_base64_vector:
+            print_uint8_vector_base64_field(ctx, td, p, f->name, f->len, (int)f->value);
+            break;
+        case flatcc_json_printer_kind_string:
+            print_string_field(ctx, td, p, f->name, f->len);
+            break;
+        case flatcc_json_printer_kind_string_vector:
+            print_string_vector_field(ctx, td, p, f->name, f->len);
+            break;
+        case flatcc_json_printer_kind_struct:
+            print_struct_field(ctx, td, p, f->name, f->len,
+                    (flatcc_json_printer_struct_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_struct_vector:
+            print_struct_vector_field(ctx, td, p, f->name, f->len,
+                    (size_t)f->value, (flatcc_json_printer_struct_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_table:
+            print_table_field(ctx, td, f->id, p, f->name, f->len,
+                    (flatcc_json_printer_table_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_table_vector:
+            print_table_vector_field(ctx, td, f->id, p, f->name, f->len,
+                    (flatcc_json_printer_table_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_union:
+            FLATCC_ASSERT(ptf && "union without a preceding union_type field");
+            print_union_field(ctx, td, f->id, p, f->name, f->len,
+                    ptf, (flatcc_json_printer_union_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_union_vector:
+            FLATCC_ASSERT(ptf && "union vector without a preceding union_type field");
+            print_union_vector_field(ctx, td, f->id, p, f->name, f->len,
+                    ptf, (flatcc_json_printer_union_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_nested_table:
+            print_table_as_nested_root(ctx, td, f->id, p, f->name, f->len,
+                    0, (flatcc_json_printer_table_f *)f->pf);
+            break;
+        case flatcc_json_printer_kind_nested_struct:
+            print_struct_as_nested_root(ctx, td, p, f->name, f->len,
+                    0, (flatcc_json_printer_struct_f *)f->pf);
+            break;
+        default:
+            RAISE_ERROR(bad_input);
+            FLATCC_ASSERT(0 && "unknown field kind");
+            return;
+        }
+    }
+}
+
 /*
  * Make sure the buffer identifier is valid before assuming the rest of
  * the buffer is sane.
@@ -1286,35 +1849,54 @@ int flatcc_json_printer_table_as_root(flatcc_json_printer_t *ctx,
     if (!accept_header(ctx, buf, bufsiz, fid)) {
         return -1;
     }
-    print_table_object(ctx, read_uoffset_ptr(buf), FLATCC_JSON_PRINT_MAX_LEVELS, pf);
+    print_table_object(ctx, read_uoffset_ptr(buf), FLATCC_JSON_PRINT_MAX_LEVELS, pf, ctx->projection);
     print_last_nl();
     return flatcc_json_printer_get_error(ctx) ? -1 : (int)ctx->total + (int)(ctx->p - ctx->buf);
 }
 
+int flatcc_json_printer_table_vector_as_ndjson(flatcc_json_printer_t *ctx,
+        const void *buf, size_t bufsiz, const char *fid, int id,
+        flatcc_json_printer_table_f *pf)
+{
+    flatcc_json_printer_table_descriptor_t td;
+    const uoffset_t *p;
+    const void *table;
+    uoffset_t count;
+    uint8_t indent = ctx->indent;
+    int level = ctx->level;
+
+    if (!accept_header(ctx, buf, bufsiz, fid)) {
+        return -1;
+    }
+    table = read_uoffset_ptr(buf);
+    td.table = table;
+    td.vtable = (uint8_t *)table - __flatbuffers_soffset_read_from_pe(table);
+    td.vsize = __flatbuffers_voffset_read_from_pe(td.vtable);
+    td.projection = ctx->projection;
+    if ((p = get_field_ptr(&td, id))) {
+        p = read_uoffset_ptr(p);
+        count = __flatbuffers_uoffset_read_from_pe(p);
+        ctx->indent = 0;
+        while (count-- && !ctx->error) {
+            ++p;
+            print_table_object(ctx, read_uoffset_ptr(p), FLATCC_JSON_PRINT_MAX_LEVELS, pf, get_child_projection(&td, id));
+            print_char('\n');
+            ctx->flush(ctx, 1);
+        }
+        /* The level is only tracked when indenting. */
+        ctx->indent = indent;
+        ctx->level = level;
+    }
+    return flatcc_json_printer_get_error(ctx) ? -1 : (int)ctx->total + (int)(ctx->p - ctx->buf);
+}
+
 void flatcc_json_printer_struct_as_nested_root(flatcc_json_printer_t *ctx,
         flatcc_json_printer_table_descriptor_t *td,
         int id, const char *name, size_t len,
         const char *fid,
         flatcc_json_printer_struct_f *pf)
 {
-    const uoffset_t *buf;
-    uoffset_t bufsiz;
-
-    if (0 == (buf = get_field_ptr(td, id))) {
-        return;
-    }
-    buf = (const uoffset_t *)((size_t)buf + __flatbuffers_uoffset_read_from_pe(buf));
-    bufsiz = __flatbuffers_uoffset_read_from_pe(buf);
-    if (!accept_header(ctx, buf, bufsiz, fid)) {
-        return;
-    }
-    if (td->count++) {
-        print_char(',');
-    }
-    print_name(ctx, name, len);
-    print_start('{');
-    pf(ctx, read_uoffset_ptr(buf));
-    print_end('}');
+    print_struct_as_nested_root(ctx, td, get_field_ptr(td, id), name, len, fid, pf);
 }
 
 void flatcc_json_printer_table_as_nested_root(flatcc_json_printer_t *ctx,
@@ -1323,23 +1905,7 @@ void flatcc_json_printer_table_as_nested_root(flatcc_json_printer_t *ctx,
         const char *fid,
         flatcc_json_printer_table_f pf)
 {
-    const uoffset_t *buf;
-    uoffset_t bufsiz;
-
-    if (0 == (buf = get_field_ptr(td, id))) {
-        return;
-    }
-    buf = (const uoffset_t *)((size_t)buf + __flatbuffers_uoffset_read_from_pe(buf));
-    bufsiz = __flatbuffers_uoffset_read_from_pe(buf);
-    ++buf;
-    if (!accept_header(ctx, buf, bufsiz, fid)) {
-        return;
-    }
-    if (td->count++) {
-        print_char(',');
-    }
-    print_name(ctx, name, len);
-    print_table_object(ctx, read_uoffset_ptr(buf), td->ttl, pf);
+    print_table_as_nested_root(ctx, td, id, get_field_ptr(td, id), name, len, fid, pf);
 }
 
 static void __flatcc_json_printer_flush(flatcc_json_printer_t *ctx, int all)
@@ -1459,6 +2025,206 @@ int flatcc_json_printer_init_dynamic_buffer(flatcc_json_printer_t *ctx, size_t b
     return 0;
 }
 
+static void __flatcc_json_printer_flush_measure(flatcc_json_printer_t *ctx, int all)
+{
+    (void)all;
+
+    ctx->total += (size_t)(ctx->p - ctx->buf);
+    ctx->p = ctx->buf;
+    *ctx->p = '\0';
+}
+
+int flatcc_json_printer_init_measure(flatcc_json_printer_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->flush = __flatcc_json_printer_flush_measure;
+    if (!(ctx->buf = FLATCC_JSON_PRINTER_ALLOC(FLATCC_JSON_PRINT_BUFFER_SIZE))) {
+        return -1;
+    }
+    ctx->own_buffer = 1;
+    ctx->size = FLATCC_JSON_PRINT_BUFFER_SIZE;
+    ctx->flush_size = FLATCC_JSON_PRINT_FLUSH_SIZE;
+    ctx->p = ctx->buf;
+    ctx->pflush = ctx->buf + ctx->flush_size;
+    return 0;
+}
+
+/*
+ * Hands the whole buffer including any spill past `pflush` to the write
+ * callback and continues in the back buffer which the callback is done
+ * with once it returns.
+ */
+static void __flatcc_json_printer_flush_writer(flatcc_json_printer_t *ctx, int all)
+{
+    size_t len = (size_t)(ctx->p - ctx->buf);
+    char *buf;
+
+    if (ctx->p >= ctx->pflush || (all && len)) {
+        if (ctx->write(ctx->write_context, ctx->buf, len)) {
+            RAISE_ERROR(write_failed);
+        }
+        ctx->total += len;
+        buf = ctx->buf;
+        ctx->buf = ctx->back_buf;
+        ctx->back_buf = buf;
+        ctx->p = ctx->buf;
+        ctx->pflush = ctx->buf + ctx->flush_size;
+    }
+    if (all && ctx->write(ctx->write_context, 0, 0)) {
+        RAISE_ERROR(write_failed);
+    }
+    *ctx->p = '\0';
+}
+
+int flatcc_json_printer_init_writer(flatcc_json_printer_t *ctx,
+        flatcc_json_printer_write_f *write, void *write_context, size_t buffer_size)
+{
+    if (buffer_size == 0) {
+        buffer_size = FLATCC_JSON_PRINT_BUFFER_SIZE;
+    }
+    if (buffer_size < 2 * FLATCC_JSON_PRINT_RESERVE) {
+        buffer_size = 2 * FLATCC_JSON_PRINT_RESERVE;
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->write = write;
+    ctx->write_context = write_context;
+    ctx->flush = __flatcc_json_printer_flush_writer;
+    ctx->buf = FLATCC_JSON_PRINTER_ALLOC(buffer_size);
+    ctx->back_buf = FLATCC_JSON_PRINTER_ALLOC(buffer_size);
+    ctx->own_buffer = 1;
+    if (!ctx->buf || !ctx->back_buf) {
+        flatcc_json_printer_clear(ctx);
+        return -1;
+    }
+    ctx->size = buffer_size;
+    ctx->flush_size = ctx->size - FLATCC_JSON_PRINT_RESERVE;
+    ctx->p = ctx->buf;
+    ctx->pflush = ctx->buf + ctx->flush_size;
+    return 0;
+}
+
+#ifdef HAS_FD_WRITE
+
+static int __flatcc_json_printer_write_fd(void *write_context, const char *data, size_t len)
+{
+    int fd = (int)(size_t)write_context;
+#if defined(_WIN32)
+    int n;
+#else
+    ssize_t n;
+#endif
+
+    while (len) {
+#if defined(_WIN32)
+        n = _write(fd, data, (unsigned)(len < 0x40000000 ? len : 0x40000000));
+#else
+        n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int flatcc_json_printer_init_fd(flatcc_json_printer_t *ctx, int fd)
+{
+    return flatcc_json_printer_init_writer(ctx,
+            __flatcc_json_printer_write_fd, (void *)(size_t)fd, 0);
+}
+
+#else
+
+int flatcc_json_printer_init_fd(flatcc_json_printer_t *ctx, int fd)
+{
+    (void)fd;
+    memset(ctx, 0, sizeof(*ctx));
+    return -1;
+}
+
+#endif
+
+/*
+ * Records the current chunk including any spill past `pflush` and
+ * continues in the next chunk, or hands over the ring when it is full
+ * or on a final flush.
+ */
+static void __flatcc_json_printer_flush_iovec(flatcc_json_printer_t *ctx, int all)
+{
+    size_t len = (size_t)(ctx->p - ctx->buf);
+
+    if (all && !ctx->iovec) {
+        /* Kept for `get_iovec`, the reserve has room past `pflush`. */
+        *ctx->p = '\0';
+        return;
+    }
+    if (ctx->p >= ctx->pflush || (all && len)) {
+        ctx->iov[ctx->iov_count].iov_base = ctx->buf;
+        ctx->iov[ctx->iov_count].iov_len = len;
+        ctx->total += len;
+        ++ctx->iov_count;
+    } else if (!(all && ctx->iov_count)) {
+        *ctx->p = '\0';
+        return;
+    }
+    if (ctx->iov_count == ctx->chunk_count || all) {
+        if (!ctx->iovec) {
+            RAISE_ERROR(overflow);
+        } else if (ctx->iovec(ctx->write_context, ctx->iov, ctx->iov_count)) {
+            RAISE_ERROR(write_failed);
+        }
+        ctx->iov_count = 0;
+    }
+    ctx->buf = ctx->chunks[ctx->iov_count];
+    ctx->p = ctx->buf;
+    ctx->pflush = ctx->buf + ctx->flush_size;
+    *ctx->p = '\0';
+}
+
+int flatcc_json_printer_init_iovec(flatcc_json_printer_t *ctx,
+        char *const *chunks, int chunk_count, size_t chunk_size,
+        flatcc_json_printer_iovec_f *iovec, void *iovec_context)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    if (!chunks || chunk_count < 1 || chunk_size < 2 * FLATCC_JSON_PRINT_RESERVE) {
+        return -1;
+    }
+    if (!(ctx->iov = FLATCC_JSON_PRINTER_ALLOC((size_t)chunk_count * sizeof(*ctx->iov)))) {
+        return -1;
+    }
+    ctx->iovec = iovec;
+    ctx->write_context = iovec_context;
+    ctx->chunks = chunks;
+    ctx->chunk_count = chunk_count;
+    ctx->flush = __flatcc_json_printer_flush_iovec;
+    ctx->buf = chunks[0];
+    ctx->size = chunk_size;
+    ctx->flush_size = ctx->size - FLATCC_JSON_PRINT_RESERVE;
+    ctx->p = ctx->buf;
+    ctx->pflush = ctx->buf + ctx->flush_size;
+    return 0;
+}
+
+const flatcc_json_printer_iovec_t *flatcc_json_printer_get_iovec(
+        flatcc_json_printer_t *ctx, int *iovcnt)
+{
+    int n = ctx->iov_count;
+
+    /* The current chunk is never complete, so it has a free slot. */
+    if (ctx->p > ctx->buf || n == 0) {
+        ctx->iov[n].iov_base = ctx->buf;
+        ctx->iov[n].iov_len = (size_t)(ctx->p - ctx->buf);
+        ++n;
+    }
+    *iovcnt = n;
+    return ctx->iov;
+}
+
 void *flatcc_json_printer_get_buffer(flatcc_json_printer_t *ctx, size_t *buffer_size)
 {
     ctx->flush(ctx, 0);
@@ -1482,5 +2248,94 @@ void flatcc_json_printer_clear(flatcc_json_printer_t *ctx)
     if (ctx->own_buffer && ctx->buf) {
         FLATCC_JSON_PRINTER_FREE(ctx->buf);
     }
+    if (ctx->own_buffer && ctx->back_buf) {
+        FLATCC_JSON_PRINTER_FREE(ctx->back_buf);
+    }
+    if (ctx->iov) {
+        FLATCC_JSON_PRINTER_FREE(ctx->iov);
+    }
     memset(ctx, 0, sizeof(*ctx));
 }
+
+void flatcc_json_printer_projection_init(flatcc_json_printer_projection_t *projection)
+{
+    memset(projection, 0, sizeof(*projection));
+}
+
+/* Covers at least the field ids below `size`, in whole bytes of the mask. */
+static int grow_projection(flatcc_json_printer_projection_t *projection, size_t size)
+{
+    flatcc_json_printer_projection_t **children;
+    uint8_t *fields;
+
+    if (size <= projection->size) {
+        return 0;
+    }
+    size = (size + 7) & ~(size_t)7;
+    if (!(fields = FLATCC_JSON_PRINTER_REALLOC(projection->fields, size / 8))) {
+        return -1;
+    }
+    projection->fields = fields;
+    memset(fields + projection->size / 8, 0, (size - projection->size) / 8);
+    if (!(children = FLATCC_JSON_PRINTER_REALLOC(projection->children, size * sizeof(*children)))) {
+        return -1;
+    }
+    projection->children = children;
+    memset(children + projection->size, 0, (size - projection->size) * sizeof(*children));
+    projection->size = size;
+    return 0;
+}
+
+int flatcc_json_printer_projection_add(flatcc_json_printer_projection_t *projection,
+        const int *path, size_t depth)
+{
+    flatcc_json_printer_projection_t *child;
+    int id;
+
+    while (depth--) {
+        id = *path++;
+        if (id < 0 || (size_t)id > FLATBUFFERS_ID_MAX || grow_projection(projection, (size_t)id + 1)) {
+            return -1;
+        }
+        child = projection->children[id];
+        if (is_selected(projection, id) && !child) {
+            /* Already selected in full. */
+            return 0;
+        }
+        if (depth == 0) {
+            if (child) {
+                flatcc_json_printer_projection_clear(child);
+                FLATCC_JSON_PRINTER_FREE(child);
+                projection->children[id] = 0;
+            }
+        } else if (!child) {
+            if (!(child = FLATCC_JSON_PRINTER_ALLOC(sizeof(*child)))) {
+                return -1;
+            }
+            flatcc_json_printer_projection_init(child);
+            projection->children[id] = child;
+        }
+        projection->fields[id >> 3] |= (uint8_t)(1 << (id & 7));
+        projection = child;
+    }
+    return 0;
+}
+
+void flatcc_json_printer_projection_clear(flatcc_json_printer_projection_t *projection)
+{
+    size_t i;
+
+    for (i = 0; i < projection->size; ++i) {
+        if (projection->children[i]) {
+            flatcc_json_printer_projection_clear(projection->children[i]);
+            FLATCC_JSON_PRINTER_FREE(projection->children[i]);
+        }
+    }
+    if (projection->fields) {
+        FLATCC_JSON_PRINTER_FREE(projection->fields);
+    }
+    if (projection->children) {
+        FLATCC_JSON_PRINTER_FREE(projection->children);
+    }
+    memset(projection, 0, sizeof(*projection));
+}
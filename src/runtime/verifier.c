@@ -97,7 +97,11 @@ const char *flatcc_verify_error_string(int err)
  */
 #define verify_runtime(cond, reason) verify(cond, reason)
 
-#define check_result(x) if (x) { return (x); }
+/*
+ * Evaluates `x` once. A failing nested verification must not run again
+ * just to return its error, which would double the work per level.
+ */
+#define check_result(x) do { int ret__tmp = (x); if (ret__tmp) { return ret__tmp; } } while (0)
 
 #define check_field(td, id, required, base) do {                            \
     int ret = get_offset_field(td, id, required, &base);                    \
@@ -295,8 +299,150 @@ static inline int verify_string_vector(const void *buf, uoffset_t end, uoffset_t
     return flatcc_verify_ok;
 }
 
+/*
+ * Errors that may be caused by data beyond the bytes received so far
+ * when verifying a partial buffer. Some also cover alignment which
+ * cannot be fixed by more data, but then the final verification of
+ * the complete buffer fails.
+ */
+static inline int is_range_error(int ret)
+{
+    switch (ret) {
+    case flatcc_verify_error_offset_out_of_range:
+    case flatcc_verify_error_struct_out_of_range:
+    case flatcc_verify_error_string_header_out_of_range_or_unaligned:
+    case flatcc_verify_error_string_out_of_range:
+    case flatcc_verify_error_vector_header_out_of_range_or_unaligned:
+    case flatcc_verify_error_vector_out_of_range:
+    case flatcc_verify_error_table_header_out_of_range_or_unaligned:
+    case flatcc_verify_error_table_size_out_of_range:
+    case flatcc_verify_error_vtable_header_out_of_range:
+    case flatcc_verify_error_vtable_size_out_of_range_or_unaligned:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * When verifying a partial buffer, a reference that reaches beyond
+ * the received data is counted and accepted for now so verification
+ * can proceed with its siblings. Only used where the caller does not
+ * access the referenced data subsequently.
+ */
+static inline int defer_partial(flatcc_verify_visited_t *visited, int ret)
+{
+    if (ret && visited && visited->partial && is_range_error(ret)) {
+        ++visited->deferred;
+        return flatcc_verify_ok;
+    }
+    return ret;
+}
+
+/* Can be used as a primitive defense against collision attacks. */
+#ifdef FLATCC_HASH_SEED
+#define _flatcc_verify_visited_seed FLATCC_HASH_SEED
+#else
+#define _flatcc_verify_visited_seed 0x2f693b52
+#endif
+
+static inline size_t visited_hash(const void *table, flatcc_table_verifier_f *tvf)
+{
+    /* MurmurHash3 64-bit finalizer, see also refmap. */
+    uint64_t x;
+
+    x = (uint64_t)((size_t)table ^ (size_t)tvf) ^ _flatcc_verify_visited_seed;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+/*
+ * Returns the matching item or the empty item where it would be
+ * inserted, or null if the table is full and the key is absent.
+ */
+static struct flatcc_verify_visited_item *visited_lookup(flatcc_verify_visited_t *visited,
+        const void *table, flatcc_table_verifier_f *tvf)
+{
+    struct flatcc_verify_visited_item *T = visited->items;
+    size_t N = visited->buckets - 1, i, k;
+
+    if (visited->buckets == 0) {
+        return 0;
+    }
+    k = visited_hash(table, tvf);
+    for (i = 0; i <= N; ++i) {
+        k &= N;
+        if (T[k].table == 0 || (T[k].table == table && T[k].tvf == tvf)) {
+            return &T[k];
+        }
+        ++k;
+    }
+    return 0;
+}
+
+/* Load factor 0.75. */
+static inline int visited_is_full(flatcc_verify_visited_t *visited)
+{
+    return visited->count >= visited->buckets - visited->buckets / 4;
+}
+
+void flatcc_verify_visited_reset(flatcc_verify_visited_t *visited)
+{
+    if (visited->count) {
+        memset(visited->items, 0, sizeof(visited->items[0]) * visited->buckets);
+    }
+    visited->count = 0;
+}
+
+static int verify_visited_table(flatcc_table_verifier_descriptor_t *td, int ttl, flatcc_table_verifier_f tvf)
+{
+    struct flatcc_verify_visited_item *item;
+    const void *table = (const uint8_t *)td->buf + td->table;
+    const void *end = (const uint8_t *)td->buf + td->end;
+    size_t deferred = td->visited->deferred;
+
+    item = visited_lookup(td->visited, table, tvf);
+    /*
+     * A table verified with no more nesting levels left than now, and
+     * within bounds no wider than now, cannot fail now. A nested buffer
+     * has narrower bounds than the enclosing buffer.
+     */
+    if (item && item->table && item->ttl <= ttl &&
+            (size_t)item->buf >= (size_t)td->buf && (size_t)item->end <= (size_t)end) {
+        return flatcc_verify_ok;
+    }
+    check_result(tvf(td));
+    /* A partially received table must be verified again later. */
+    if (td->visited->deferred != deferred) {
+        return flatcc_verify_ok;
+    }
+    /* Recursion may have inserted other tables, so look up again. */
+    item = visited_lookup(td->visited, table, tvf);
+    if (item == 0) {
+        return flatcc_verify_ok;
+    }
+    if (item->table == 0) {
+        if (visited_is_full(td->visited)) {
+            return flatcc_verify_ok;
+        }
+        ++td->visited->count;
+        item->table = table;
+        item->tvf = tvf;
+    }
+    item->buf = td->buf;
+    item->end = end;
+    item->ttl = ttl;
+    return flatcc_verify_ok;
+}
+
 static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
-        int ttl, flatcc_table_verifier_f tvf)
+        int ttl, flatcc_table_verifier_f tvf, flatcc_verify_visited_t *visited,
+        flatcc_verify_diagnostics_t *diag)
 {
     uoffset_t vbase, vend;
     flatcc_table_verifier_descriptor_t td;
@@ -322,10 +468,17 @@ static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, u
     td.vtable = (uint8_t *)buf + vbase;
     td.buf = buf;
     td.end = end;
+    td.visited = visited;
+    td.diag = diag;
+    if (visited) {
+        return verify_visited_table(&td, ttl, tvf);
+    }
     return tvf(&td);
 }
 
-static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf)
+static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        int ttl, flatcc_table_verifier_f tvf, flatcc_verify_visited_t *visited,
+        flatcc_verify_diagnostics_t *diag)
 {
     uoffset_t i, n;
 
@@ -335,13 +488,15 @@ static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t
     n = read_uoffset(buf, base);
     base += offset_size;
     for (i = 0; i < n; ++i, base += offset_size) {
-        check_result(verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf));
+        check_result(defer_partial(visited,
+                verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf, visited, diag)));
     }
     return flatcc_verify_ok;
 }
 
 static inline int verify_union_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
-        uoffset_t count, const utype_t *types, int ttl, flatcc_union_verifier_f uvf)
+        uoffset_t count, const utype_t *types, int ttl, flatcc_union_verifier_f uvf,
+        flatcc_verify_visited_t *visited, flatcc_verify_diagnostics_t *diag)
 {
     uoffset_t i, n, elem;
     flatcc_union_verifier_descriptor_t ud;
@@ -356,6 +511,8 @@ static inline int verify_union_vector(const void *buf, uoffset_t end, uoffset_t
     ud.buf = buf;
     ud.end = end;
     ud.ttl = ttl;
+    ud.visited = visited;
+    ud.diag = diag;
 
     for (i = 0; i < n; ++i, base += offset_size) {
         /* Table vectors can never be null, but unions can when the type is NONE. */
@@ -367,12 +524,33 @@ static inline int verify_union_vector(const void *buf, uoffset_t end, uoffset_t
             ud.type = types[i];
             ud.base = base;
             ud.offset = elem;
-            check_result(uvf(&ud));
+            check_result(defer_partial(visited, uvf(&ud)));
         }
     }
     return flatcc_verify_ok;
 }
 
+int flatcc_verify_table_error(flatcc_table_verifier_descriptor_t *td, int err,
+        voffset_t id, const char *type_name)
+{
+    flatcc_verify_diagnostics_t *diag = td->diag;
+
+    if (diag == 0) {
+        return err;
+    }
+    if (diag->depth == 0) {
+        /* The vtable header is verified, so entries can be read safely. */
+        diag->offset = (size_t)((const uint8_t *)td->buf + td->table
+                + read_vt_entry(td, id) - (const uint8_t *)diag->buf);
+    }
+    if (diag->depth < FLATCC_VERIFY_DIAGNOSTICS_MAX_PATH) {
+        diag->path[diag->depth].type_name = type_name;
+        diag->path[diag->depth].id = id;
+    }
+    ++diag->depth;
+    return err;
+}
+
 int flatcc_verify_field(flatcc_table_verifier_descriptor_t *td,
         voffset_t id, size_t size, uint16_t align)
 {
@@ -386,10 +564,10 @@ int flatcc_verify_string_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_string(td->buf, td->end, base, read_uoffset(td->buf, base));
+    return defer_partial(td->visited, verify_string(td->buf, td->end, base, read_uoffset(td->buf, base)));
 }
 
-int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
+static int verify_vector_field(flatcc_table_verifier_descriptor_t *td,
         voffset_t id, int required, size_t elem_size, uint16_t align, size_t max_count)
 {
     uoffset_t base;
@@ -399,13 +577,19 @@ int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
         (uoffset_t)elem_size, align, (uoffset_t)max_count);
 }
 
+int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
+        voffset_t id, int required, size_t elem_size, uint16_t align, size_t max_count)
+{
+    return defer_partial(td->visited, verify_vector_field(td, id, required, elem_size, align, max_count));
+}
+
 int flatcc_verify_string_vector_field(flatcc_table_verifier_descriptor_t *td,
     voffset_t id, int required)
 {
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base));
+    return defer_partial(td->visited, verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base)));
 }
 
 int flatcc_verify_table_field(flatcc_table_verifier_descriptor_t *td,
@@ -414,7 +598,8 @@ int flatcc_verify_table_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    return defer_partial(td->visited,
+            verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->visited, td->diag));
 }
 
 int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -423,12 +608,13 @@ int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    return defer_partial(td->visited,
+            verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->visited, td->diag));
 }
 
 int flatcc_verify_union_table(flatcc_union_verifier_descriptor_t *ud, flatcc_table_verifier_f *tvf)
 {
-    return verify_table(ud->buf, ud->end, ud->base, ud->offset, ud->ttl, tvf);
+    return verify_table(ud->buf, ud->end, ud->base, ud->offset, ud->ttl, tvf, ud->visited, ud->diag);
 }
 
 int flatcc_verify_union_struct(flatcc_union_verifier_descriptor_t *ud, size_t size, uint16_t align)
@@ -479,7 +665,7 @@ int flatcc_verify_buffer_header_with_size(const void *buf, size_t *bufsiz, const
     verify_runtime(size_field <= *bufsiz - offset_size, flatcc_verify_error_runtime_buffer_size_less_than_size_field);
     if (fid != 0) {
         id2 = read_thash_identifier(fid);
-        id = read_thash(buf, offset_size);
+        id = read_thash(buf, 2 * offset_size);
         verify(id2 == 0 || id == id2, flatcc_verify_error_identifier_mismatch);
     }
     *bufsiz = size_field + offset_size;
@@ -524,7 +710,7 @@ int flatcc_verify_typed_buffer_header_with_size(const void *buf, size_t *bufsiz,
     verify_runtime(size_field <= *bufsiz - offset_size, flatcc_verify_error_runtime_buffer_size_less_than_size_field);
     if (thash != 0) {
         id2 = thash;
-        id = read_thash(buf, offset_size);
+        id = read_thash(buf, 2 * offset_size);
         verify(id2 == 0 || id == id2, flatcc_verify_error_identifier_mismatch);
     }
     *bufsiz = size_field + offset_size;
@@ -558,25 +744,101 @@ int flatcc_verify_struct_as_typed_root_with_size(const void *buf, size_t bufsiz,
 int flatcc_verify_table_as_root(const void *buf, size_t bufsiz, const char *fid, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
-    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_root_with_size(const void *buf, size_t bufsiz, const char *fid, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
-    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_typed_root(const void *buf, size_t bufsiz, flatbuffers_thash_t thash, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_typed_buffer_header(buf, bufsiz, thash));
-    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_typed_root_with_size(const void *buf, size_t bufsiz, flatbuffers_thash_t thash, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_typed_buffer_header_with_size(buf, &bufsiz, thash));
-    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
+}
+
+int flatcc_verify_table_as_root_with_visited(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_visited_t *visited)
+{
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, visited, 0);
+}
+
+int flatcc_verify_table_as_root_with_size_and_visited(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_visited_t *visited)
+{
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, visited, 0);
+}
+
+static int verify_table_as_root_with_diagnostics(const void *buf, size_t bufsiz, uoffset_t base,
+        flatcc_table_verifier_f *tvf, flatcc_verify_diagnostics_t *diag)
+{
+    return diag->error = verify_table(buf, (uoffset_t)bufsiz, base, read_uoffset(buf, base),
+            FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, diag);
+}
+
+int flatcc_verify_table_as_root_with_diagnostics(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_diagnostics_t *diag)
+{
+    diag->buf = buf;
+    diag->offset = 0;
+    diag->depth = 0;
+    if ((diag->error = flatcc_verify_buffer_header(buf, bufsiz, fid))) {
+        return diag->error;
+    }
+    return verify_table_as_root_with_diagnostics(buf, bufsiz, 0, tvf, diag);
+}
+
+int flatcc_verify_table_as_root_with_size_and_diagnostics(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_diagnostics_t *diag)
+{
+    diag->buf = buf;
+    diag->offset = 0;
+    diag->depth = 0;
+    if ((diag->error = flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid))) {
+        return diag->error;
+    }
+    return verify_table_as_root_with_diagnostics(buf, bufsiz, uoffset_size, tvf, diag);
+}
+
+int flatcc_verify_table_as_root_with_size_partial(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_visited_t *visited)
+{
+    size_t size;
+    int ret;
+
+    verify_runtime(visited != 0, flatcc_verify_error_runtime_visited_set_missing);
+    verify_runtime(!(((size_t)buf) & (offset_size - 1)), flatcc_verify_error_runtime_buffer_header_not_aligned);
+    if (bufsiz < 2 * offset_size + FLATBUFFERS_IDENTIFIER_SIZE) {
+        return flatcc_verify_error_buffer_incomplete;
+    }
+    size = (size_t)read_uoffset(buf, 0);
+    verify_runtime(size <= FLATBUFFERS_UOFFSET_MAX - 8 - offset_size, flatcc_verify_error_runtime_buffer_size_too_large);
+    size += offset_size;
+    if (size > bufsiz) {
+        visited->partial = 1;
+    } else {
+        visited->partial = 0;
+        bufsiz = size;
+    }
+    check_result(flatcc_verify_buffer_header_with_size(buf, &size, fid));
+    visited->deferred = 0;
+    ret = defer_partial(visited, verify_table(buf, (uoffset_t)bufsiz, uoffset_size,
+                read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, visited, 0));
+    if (ret == flatcc_verify_ok && visited->deferred) {
+        ret = flatcc_verify_error_buffer_incomplete;
+    }
+    visited->partial = 0;
+    return ret;
 }
 
 int flatcc_verify_struct_as_nested_root(flatcc_table_verifier_descriptor_t *td,
@@ -584,8 +846,12 @@ int flatcc_verify_struct_as_nested_root(flatcc_table_verifier_descriptor_t *td,
 {
     const uoffset_t *buf;
     uoffset_t bufsiz;
+    int ret;
 
-    check_result(flatcc_verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)));
+    /* The nested buffer is read below, so a partial vector must end verification here. */
+    if ((ret = verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)))) {
+        return defer_partial(td->visited, ret);
+    }
     if (0 == (buf = get_field_ptr(td, id))) {
         return flatcc_verify_ok;
     }
@@ -601,8 +867,12 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
 {
     const uoffset_t *buf;
     uoffset_t bufsiz;
+    int ret;
 
-    check_result(flatcc_verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)));
+    /* The nested buffer is read below, so a partial vector must end verification here. */
+    if ((ret = verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)))) {
+        return defer_partial(td->visited, ret);
+    }
     if (0 == (buf = get_field_ptr(td, id))) {
         return flatcc_verify_ok;
     }
@@ -614,7 +884,7 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
      * might not be what is desired anyway. User can do it later.
      */
     check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
-    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf);
+    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf, td->visited, td->diag);
 }
 
 int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
@@ -645,10 +915,12 @@ int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
     ud.buf = td->buf;
     ud.end = td->end;
     ud.ttl = td->ttl;
+    ud.visited = td->visited;
+    ud.diag = td->diag;
     ud.base = base;
     ud.offset = read_uoffset(td->buf, base);
     ud.type = *type;
-    return uvf(&ud);
+    return defer_partial(td->visited, uvf(&ud));
 }
 
 int flatcc_verify_union_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -658,14 +930,17 @@ int flatcc_verify_union_vector_field(flatcc_table_verifier_descriptor_t *td,
     const uoffset_t *buf;
     const utype_t *types;
     uoffset_t count, base;
+    int ret;
 
     if (0 == (vte_type = read_vt_entry(td, id - 1))) {
         if (0 == (vte_table = read_vt_entry(td, id))) {
             verify(!required, flatcc_verify_error_type_field_absent_from_required_union_vector_field);
         }
     }
-    check_result(flatcc_verify_vector_field(td, id - 1, required,
-                utype_size, utype_size, FLATBUFFERS_COUNT_MAX(utype_size)));
+    if ((ret = verify_vector_field(td, id - 1, required,
+                utype_size, utype_size, FLATBUFFERS_COUNT_MAX(utype_size)))) {
+        return defer_partial(td->visited, ret);
+    }
     if (0 == (buf = get_field_ptr(td, id - 1))) {
         return flatcc_verify_ok;
     }
@@ -675,6 +950,6 @@ int flatcc_verify_union_vector_field(flatcc_table_verifier_descriptor_t *td,
     types = (utype_t *)buf;
 
     check_field(td, id, required, base);
-    return verify_union_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
-            count, types, td->ttl, uvf);
+    return defer_partial(td->visited, verify_union_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
+            count, types, td->ttl, uvf, td->visited, td->diag));
 }
@@ -14,3 +14,9 @@ echo "building and benchmarking flatcc generated C"
 benchflatcc/run.sh
 echo "building and benchmarking flatcc json generated C"
 benchflatccjson/run.sh
+echo "building and benchmarking flatcc verifier generated C"
+benchverify/run.sh
+echo "building and benchmarking flatcc json parser generated C"
+benchjsonparse/run.sh
+echo "building and benchmarking flatcc json printer generated C"
+benchjsonprint/run.sh
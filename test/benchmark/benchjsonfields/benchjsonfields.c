@@ -0,0 +1,153 @@
+/*
+ * JSON parser throughput on wide tables and large enums where names
+ * share long prefixes. The same source is compiled against parsers
+ * generated with and without `--json-parser-hash` so trie and perfect
+ * hash name matching can be compared, see `run.sh`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsonfieldsbench_json_parser.h"
+#include "flatcc/support/elapsed.h"
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#ifndef DISPATCH
+#define DISPATCH "trie"
+#endif
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(benchjsonfields, x)
+
+/* Approximate size of each generated JSON document. */
+#define DOC_SIZE 1000000
+/* Approximate number of bytes parsed per shape. */
+#define BENCH_VOLUME 200000000
+
+#define FIELD_COUNT 128
+#define STATUS_COUNT 64
+
+typedef struct doc_shape {
+    const char *shape;
+    /* Fields set per reading. */
+    int fields;
+    /* Status symbols per reading. */
+    int symbols;
+    /* Names in random order, otherwise in the same order per reading. */
+    int shuffle;
+} doc_shape_t;
+
+static unsigned next_random(unsigned *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (*seed >> 16) & 0x7fff;
+}
+
+static char *create_doc(const doc_shape_t *s, size_t *size)
+{
+    char *doc, *p;
+    int i, k, t, n = 0, order[FIELD_COUNT];
+    unsigned seed = 1;
+
+    if (!(doc = malloc(DOC_SIZE + 100 * (FIELD_COUNT + (size_t)s->symbols)))) {
+        return 0;
+    }
+    p = doc;
+    p += sprintf(p, "{\"readings\":[");
+    while ((size_t)(p - doc) < DOC_SIZE) {
+        p += sprintf(p, "%s\n{", n ? "," : "");
+        for (i = 0; i < FIELD_COUNT; ++i) {
+            order[i] = (i * 37) % FIELD_COUNT;
+        }
+        for (i = 0; s->shuffle && i < FIELD_COUNT; ++i) {
+            k = (int)(next_random(&seed) % (unsigned)(FIELD_COUNT - i)) + i;
+            t = order[i];
+            order[i] = order[k];
+            order[k] = t;
+        }
+        for (i = 0; i < s->fields; ++i) {
+            p += sprintf(p, "%s\"sensor_reading_channel_%03d\":%d", i ? "," : "",
+                    order[i], i + n);
+        }
+        if (s->symbols) {
+            p += sprintf(p, "%s\"status\":[", s->fields ? "," : "");
+            for (i = 0; i < s->symbols; ++i) {
+                k = s->shuffle ? (int)(next_random(&seed) % STATUS_COUNT) : (i * 11) % STATUS_COUNT;
+                p += sprintf(p, "%s\"operating_status_condition_%02d\"", i ? "," : "", k);
+            }
+            *p++ = ']';
+        }
+        *p++ = '}';
+        ++n;
+    }
+    p += sprintf(p, "]}");
+    *size = (size_t)(p - doc);
+    return doc;
+}
+
+static int bench(flatcc_builder_t *B, const doc_shape_t *s)
+{
+    flatcc_json_parser_t parser;
+    char title[100];
+    double t1, t2;
+    char *doc;
+    size_t size;
+    int i, rep, ret = 0;
+
+    if (!(doc = create_doc(s, &size))) {
+        printf("ABORT ON ALLOCATION FAILURE: %s\n", s->shape);
+        return -1;
+    }
+    rep = (int)(BENCH_VOLUME / size) + 1;
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        flatcc_builder_reset(B);
+        if ((ret = ns(Doc_parse_json_as_root(B, &parser, doc, size, 0, 0)))) {
+            break;
+        }
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON PARSE FAILURE: %s: %s, line %d, pos %d\n", s->shape,
+                flatcc_json_parser_error_string(ret), parser.line, parser.pos);
+    } else {
+        sprintf(title, "flatcc json parse %s, " DISPATCH " " COMPILE_TYPE, s->shape);
+        show_benchmark(title, t1, t2, size, rep, 0);
+        printf("\n");
+    }
+    free(doc);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const doc_shape_t shapes[] = {
+        { "wide table", FIELD_COUNT, 0, 0 },
+        { "wide table, random order", FIELD_COUNT, 0, 1 },
+        { "large enum", 4, 32, 0 },
+        { "large enum, random order", 4, 32, 1 },
+    };
+    flatcc_builder_t builder, *B;
+    size_t i;
+    int ret = 0;
+
+    (void)argc;
+    (void)argv;
+
+    B = &builder;
+    flatcc_builder_init(B);
+
+    printf("----\n");
+    for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]) && !ret; ++i) {
+        ret = bench(B, &shapes[i]);
+    }
+    printf("----\n");
+    flatcc_builder_clear(B);
+    return ret;
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchjsonfields
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}/trie ${TMP}/hash
+rm -rf ${TMP}/trie/* ${TMP}/hash/*
+bin/flatcc --json-parser -a -o ${TMP}/trie test/benchmark/schema/jsonfieldsbench.fbs
+bin/flatcc --json-parser-hash -a -o ${TMP}/hash test/benchmark/schema/jsonfieldsbench.fbs
+
+CC=${CC:-cc}
+cp -r test/benchmark/benchjsonfields/* ${TMP}
+cd ${TMP}
+for dispatch in trie hash; do
+    $CC -O3 -DNDEBUG -std=c11 -I ${dispatch} -I ${ROOT}/include \
+        -DDISPATCH=\"${dispatch}\" benchjsonfields.c \
+        ${ROOT}/lib/libflatccrt.a -o benchjsonfields_${dispatch}
+done
+echo "running flatcc json parser field matching benchmark for C (optimized)"
+./benchjsonfields_trie
+./benchjsonfields_hash
@@ -0,0 +1,353 @@
+/*
+ * JSON parser throughput on large arrays of strings. Each document
+ * shape is generated once as JSON text of roughly the same size and
+ * parsed repeatedly with `Doc_parse_json_as_root`. The shapes differ in
+ * string length, indentation, and escapes, so the effect of changes to
+ * string and whitespace scanning can be tracked separately.
+ *
+ * Numeric shapes hold integer or double sensor readings printed with
+ * different precision to track number conversion.
+ *
+ * NDJSON input with one small document per line is parsed with
+ * `Doc_parse_ndjson`, first in one thread and then split at newlines
+ * across worker threads with a builder each.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "jsonparsebench_json_parser.h"
+#include "flatcc/support/elapsed.h"
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(benchjsonparse, x)
+
+/* Approximate size of each generated JSON document. */
+#define DOC_SIZE 1000000
+/* Approximate number of bytes parsed per shape. */
+#define BENCH_VOLUME 500000000
+/* Worker threads for the threaded NDJSON run. */
+#define NDJSON_THREADS 4
+
+typedef struct doc_shape {
+    const char *shape;
+    /* Length of string content, excluding quotes. */
+    int len;
+    /* Spaces before each element on its own line, or -1 for compact. */
+    int indent;
+    /* Insert an escape every `escape` characters, or 0 for none. */
+    int escape;
+} doc_shape_t;
+
+static char *create_doc(const doc_shape_t *s, size_t *size)
+{
+    /* Room for one more element in addition to the document size. */
+    size_t cap = DOC_SIZE + 2 * (size_t)s->len + (size_t)s->indent + 100;
+    char *doc, *p;
+    int i, n = 0;
+
+    if (!(doc = malloc(cap))) {
+        return 0;
+    }
+    p = doc;
+    p += sprintf(p, "{\"names\":[");
+    while ((size_t)(p - doc) < DOC_SIZE) {
+        if (n++) {
+            *p++ = ',';
+        }
+        if (s->indent >= 0) {
+            *p++ = '\n';
+            memset(p, ' ', (size_t)s->indent);
+            p += s->indent;
+        }
+        *p++ = '\"';
+        for (i = 0; i < s->len; ++i) {
+            if (s->escape && i % s->escape == s->escape - 1) {
+                *p++ = '\\';
+                *p++ = 'n';
+            } else {
+                *p++ = (char)('a' + (i + n) % 26);
+            }
+        }
+        *p++ = '\"';
+    }
+    p += sprintf(p, "%s]}", s->indent >= 0 ? "\n" : "");
+    *size = (size_t)(p - doc);
+    return doc;
+}
+
+typedef struct number_shape {
+    const char *shape;
+    /* Vector field holding the numbers. */
+    const char *field;
+    /* Format of each number, either "%d" or a double format. */
+    const char *format;
+} number_shape_t;
+
+static char *create_number_doc(const number_shape_t *s, size_t *size)
+{
+    char *doc, *p;
+    unsigned x = 1;
+    int n = 0;
+
+    if (!(doc = malloc(DOC_SIZE + 100))) {
+        return 0;
+    }
+    p = doc;
+    p += sprintf(p, "{\"%s\":[", s->field);
+    while ((size_t)(p - doc) < DOC_SIZE) {
+        if (n++) {
+            *p++ = ',';
+        }
+        x = x * 1103515245 + 12345;
+        if (!strcmp(s->format, "%d")) {
+            p += sprintf(p, s->format, (int)(x >> 1) - (1 << 30));
+        } else {
+            p += sprintf(p, s->format, ((double)(x >> 8) - (1 << 23)) / (1 << (x & 15)));
+        }
+    }
+    p += sprintf(p, "]}");
+    *size = (size_t)(p - doc);
+    return doc;
+}
+
+static int parse(flatcc_builder_t *B, flatcc_json_parser_t *parser,
+        const char *doc, size_t size)
+{
+    flatcc_builder_reset(B);
+    return ns(Doc_parse_json_as_root(B, parser, doc, size, 0, 0));
+}
+
+static int bench(flatcc_builder_t *B, const doc_shape_t *s)
+{
+    flatcc_json_parser_t parser;
+    char title[100];
+    double t1, t2;
+    char *doc;
+    size_t size;
+    int i, rep, ret = 0;
+
+    if (!(doc = create_doc(s, &size))) {
+        printf("ABORT ON ALLOCATION FAILURE: %s\n", s->shape);
+        return -1;
+    }
+    rep = (int)(BENCH_VOLUME / size) + 1;
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        if ((ret = parse(B, &parser, doc, size))) {
+            break;
+        }
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON PARSE FAILURE: %s: %s, line %d, pos %d\n", s->shape,
+                flatcc_json_parser_error_string(ret), parser.line, parser.pos);
+    } else {
+        sprintf(title, "flatcc json parse %s " COMPILE_TYPE, s->shape);
+        show_benchmark(title, t1, t2, size, rep, 0);
+        printf("\n");
+    }
+    free(doc);
+    return ret;
+}
+
+static int bench_numbers(flatcc_builder_t *B, const number_shape_t *s)
+{
+    flatcc_json_parser_t parser;
+    char title[100];
+    double t1, t2;
+    char *doc;
+    size_t size;
+    int i, rep, ret = 0;
+
+    if (!(doc = create_number_doc(s, &size))) {
+        printf("ABORT ON ALLOCATION FAILURE: %s\n", s->shape);
+        return -1;
+    }
+    rep = (int)(BENCH_VOLUME / size) + 1;
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        if ((ret = parse(B, &parser, doc, size))) {
+            break;
+        }
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON PARSE FAILURE: %s: %s, line %d, pos %d\n", s->shape,
+                flatcc_json_parser_error_string(ret), parser.line, parser.pos);
+    } else {
+        sprintf(title, "flatcc json parse %s " COMPILE_TYPE, s->shape);
+        show_benchmark(title, t1, t2, size, rep, 0);
+        printf("\n");
+    }
+    free(doc);
+    return ret;
+}
+
+static char *create_ndjson(size_t *size)
+{
+    char *doc, *p;
+    int n = 0;
+
+    if (!(doc = malloc(DOC_SIZE + 200))) {
+        return 0;
+    }
+    p = doc;
+    while ((size_t)(p - doc) < DOC_SIZE) {
+        p += sprintf(p, "{\"names\":[\"event %d\",\"source %d\",\"message number %d\"]}\n",
+                n, n % 17, n);
+        ++n;
+    }
+    *size = (size_t)(p - doc);
+    return doc;
+}
+
+typedef struct ndjson_worker {
+    const char *buf;
+    size_t size;
+    /* Buffers and bytes emitted. */
+    size_t count;
+    size_t bytes;
+    int ret;
+#ifndef _WIN32
+    pthread_t thread;
+#endif
+} ndjson_worker_t;
+
+static int ndjson_emit(void *emit_context, const void *buf, size_t bufsiz)
+{
+    ndjson_worker_t *w = emit_context;
+
+    (void)buf;
+    w->bytes += bufsiz;
+    return 0;
+}
+
+static void *ndjson_run(void *arg)
+{
+    ndjson_worker_t *w = arg;
+    flatcc_builder_t builder;
+
+    flatcc_builder_init(&builder);
+    w->ret = ns(Doc_parse_ndjson(&builder, 0, w->buf, w->size, 0, 0, ndjson_emit, w, &w->count));
+    flatcc_builder_clear(&builder);
+    return 0;
+}
+
+static int ndjson_parse(const char *doc, size_t size, size_t threads, size_t *count)
+{
+    ndjson_worker_t workers[NDJSON_THREADS];
+    size_t offsets[NDJSON_THREADS + 1], i, n;
+    int ret = 0;
+
+    n = flatcc_json_parser_ndjson_split(doc, size, threads, offsets);
+    for (i = 0; i < n; ++i) {
+        memset(&workers[i], 0, sizeof(workers[i]));
+        workers[i].buf = doc + offsets[i];
+        workers[i].size = offsets[i + 1] - offsets[i];
+#ifndef _WIN32
+        if (n > 1) {
+            if (pthread_create(&workers[i].thread, 0, ndjson_run, &workers[i])) {
+                return -1;
+            }
+            continue;
+        }
+#endif
+        ndjson_run(&workers[i]);
+    }
+    *count = 0;
+    for (i = 0; i < n; ++i) {
+#ifndef _WIN32
+        if (n > 1) {
+            pthread_join(workers[i].thread, 0);
+        }
+#endif
+        ret |= workers[i].ret;
+        *count += workers[i].count;
+    }
+    return ret;
+}
+
+static int bench_ndjson(size_t threads)
+{
+    char title[100];
+    double t1, t2;
+    char *doc;
+    size_t size, count = 0;
+    int i, rep, ret = 0;
+
+    if (!(doc = create_ndjson(&size))) {
+        printf("ABORT ON ALLOCATION FAILURE: ndjson\n");
+        return -1;
+    }
+    rep = (int)(BENCH_VOLUME / size) + 1;
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep && !ret; ++i) {
+        ret = ndjson_parse(doc, size, threads, &count);
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON PARSE FAILURE: ndjson: %s\n", flatcc_json_parser_error_string(ret));
+    } else {
+        sprintf(title, "flatcc json parse ndjson, %d lines, %d thread%s " COMPILE_TYPE,
+                (int)count, (int)threads, threads > 1 ? "s" : "");
+        show_benchmark(title, t1, t2, size, rep, 0);
+        printf("\n");
+    }
+    free(doc);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const doc_shape_t shapes[] = {
+        { "short strings", 12, -1, 0 },
+        { "long strings", 200, -1, 0 },
+        { "indented long strings", 200, 16, 0 },
+        { "deeply indented short strings", 12, 64, 0 },
+        { "escaped long strings", 200, -1, 40 },
+    };
+    static const number_shape_t number_shapes[] = {
+        { "integer readings", "readings", "%d" },
+        { "double readings, 3 decimals", "values", "%.3f" },
+        { "double readings, round trip", "values", "%.17g" },
+    };
+    flatcc_builder_t builder, *B;
+    size_t i;
+    int ret = 0;
+
+    (void)argc;
+    (void)argv;
+
+    B = &builder;
+    flatcc_builder_init(B);
+
+    printf("----\n");
+    for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]) && !ret; ++i) {
+        ret = bench(B, &shapes[i]);
+    }
+    for (i = 0; i < sizeof(number_shapes) / sizeof(number_shapes[0]) && !ret; ++i) {
+        ret = bench_numbers(B, &number_shapes[i]);
+    }
+    if (!ret) {
+        ret = bench_ndjson(1);
+    }
+#ifndef _WIN32
+    if (!ret) {
+        ret = bench_ndjson(NDJSON_THREADS);
+    }
+#endif
+    printf("----\n");
+    flatcc_builder_clear(B);
+    return ret;
+}
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchjsonparse
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}
+rm -rf ${TMP}/*
+bin/flatcc --json-parser -a -o ${TMP} test/benchmark/schema/jsonparsebench.fbs
+
+CC=${CC:-cc}
+cp -r test/benchmark/benchjsonparse/* ${TMP}
+cd ${TMP}
+$CC -g -std=c11 -pthread -I ${ROOT}/include benchjsonparse.c \
+    ${ROOT}/lib/libflatccrt_d.a -o benchjsonparse_d
+$CC -O3 -DNDEBUG -std=c11 -pthread -I ${ROOT}/include benchjsonparse.c \
+    ${ROOT}/lib/libflatccrt.a -o benchjsonparse
+echo "running flatcc json parser benchmark for C (debug)"
+./benchjsonparse_d
+echo "running flatcc json parser benchmark for C (optimized)"
+./benchjsonparse
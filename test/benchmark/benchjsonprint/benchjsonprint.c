@@ -0,0 +1,233 @@
+/*
+ * JSON printer throughput on string content and numeric vectors. Each
+ * buffer shape is built once with roughly the same printed size and
+ * printed repeatedly into a fixed buffer. The string shapes differ in
+ * string length, content and escapes, so the effect of changes to
+ * escape scanning in strings and fixed length char arrays can be
+ * tracked separately. The numeric shapes print vectors of doubles with
+ * few or all significant digits, floats, and integers of varying
+ * length, which is bound by float and integer formatting.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsonprintbench_builder.h"
+#include "jsonprintbench_json_printer.h"
+#include "flatcc/support/elapsed.h"
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(benchjsonprint, x)
+
+/* Approximate size of each printed JSON document. */
+#define DOC_SIZE 1000000
+/* Approximate number of bytes printed per shape. */
+#define BENCH_VOLUME 500000000
+
+#define LABEL_SIZE 64
+
+enum { no_numbers, short_doubles, doubles, floats, longs };
+
+typedef struct doc_shape {
+    const char *shape;
+    /* Length of string content in bytes, or approximate printed length of numbers. */
+    int len;
+    /* Content is 2 byte UTF-8 encoded characters rather than ASCII. */
+    int utf8;
+    /* Insert a newline every `escape` bytes, or 0 for none. */
+    int escape;
+    /* Print as fixed length char arrays instead of strings, len < 64. */
+    int label;
+    /* Print a numeric vector of the given kind instead of strings. */
+    int numbers;
+} doc_shape_t;
+
+static unsigned next_random(unsigned *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (*seed >> 16) & 0x7fff;
+}
+
+static int create_numbers(flatcc_builder_t *B, const doc_shape_t *s, int count)
+{
+    unsigned seed = 1;
+    double x;
+    int n, ret = 0;
+
+    switch (s->numbers) {
+    case short_doubles:
+    case doubles:
+        ns(Doc_values_start(B));
+        break;
+    case floats:
+        ns(Doc_samples_start(B));
+        break;
+    default:
+        ns(Doc_counts_start(B));
+        break;
+    }
+    for (n = 0; n < count && !ret; ++n) {
+        x = (next_random(&seed) * 32768.0 + next_random(&seed)) / 1073741824.0;
+        switch (s->numbers) {
+        case short_doubles:
+            /* Readings such as 1234.5 or 0.0123. */
+            x = (double)(next_random(&seed) % 100000) / (n % 2 ? 10.0 : 1000000.0);
+            ret = !ns(Doc_values_push_create(B, x));
+            break;
+        case doubles:
+            ret = !ns(Doc_values_push_create(B, x * 1000.0));
+            break;
+        case floats:
+            ret = !ns(Doc_samples_push_create(B, (float)(x * 1000.0)));
+            break;
+        default:
+            ret = !ns(Doc_counts_push_create(B,
+                    (int64_t)(x * 1e15) >> (next_random(&seed) % 48)));
+            break;
+        }
+    }
+    switch (s->numbers) {
+    case short_doubles:
+    case doubles:
+        ns(Doc_values_end(B));
+        break;
+    case floats:
+        ns(Doc_samples_end(B));
+        break;
+    default:
+        ns(Doc_counts_end(B));
+        break;
+    }
+    return ret ? -1 : 0;
+}
+
+static void fill(const doc_shape_t *s, char *text, int n)
+{
+    int i;
+
+    for (i = 0; i < s->len; ++i) {
+        if (s->escape && i % s->escape == s->escape - 1) {
+            text[i] = '\n';
+        } else if (s->utf8) {
+            /* U+00E0..U+00FF. */
+            text[i] = (char)(i % 2 ? 0xa0 + (i / 2 + n) % 32 : 0xc3);
+        } else {
+            text[i] = (char)('a' + (i + n) % 26);
+        }
+    }
+}
+
+static int create_doc(flatcc_builder_t *B, const doc_shape_t *s)
+{
+    char text[1000];
+    ns(Label_t) *label;
+    int n, count = DOC_SIZE / (s->len + 3);
+
+    flatcc_builder_reset(B);
+    ns(Doc_start_as_root(B));
+    if (s->numbers) {
+        if (create_numbers(B, s, count)) {
+            return -1;
+        }
+    } else if (s->label) {
+        ns(Doc_labels_start(B));
+        for (n = 0; n < count; ++n) {
+            if (!(label = ns(Doc_labels_extend(B, 1)))) {
+                return -1;
+            }
+            memset(label->text, 0, LABEL_SIZE);
+            fill(s, label->text, n);
+        }
+        ns(Doc_labels_end(B));
+    } else {
+        ns(Doc_names_start(B));
+        for (n = 0; n < count; ++n) {
+            fill(s, text, n);
+            if (!ns(Doc_names_push_create(B, text, (size_t)s->len))) {
+                return -1;
+            }
+        }
+        ns(Doc_names_end(B));
+    }
+    return ns(Doc_end_as_root(B)) ? 0 : -1;
+}
+
+static int bench(flatcc_builder_t *B, const doc_shape_t *s, char *out, size_t out_size)
+{
+    flatcc_json_printer_t printer;
+    char title[100];
+    double t1, t2;
+    void *buffer;
+    size_t size, printed = 0;
+    int i, rep, ret = 0;
+
+    if (create_doc(B, s) || !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        printf("ABORT ON BUILD FAILURE: %s\n", s->shape);
+        return -1;
+    }
+    rep = (int)(BENCH_VOLUME / DOC_SIZE) + 1;
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        flatcc_json_printer_init_buffer(&printer, out, out_size);
+        printed = (size_t)ns(Doc_print_json_as_root(&printer, buffer, size, 0));
+        if ((ret = flatcc_json_printer_get_error(&printer))) {
+            break;
+        }
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON PRINT FAILURE: %s: %s\n", s->shape,
+                flatcc_json_printer_error_string(ret));
+    } else {
+        sprintf(title, "flatcc json print %s " COMPILE_TYPE, s->shape);
+        show_benchmark(title, t1, t2, printed, rep, 0);
+        printf("\n");
+    }
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const doc_shape_t shapes[] = {
+        { "short strings", 12, 0, 0, 0, 0 },
+        { "long strings", 200, 0, 0, 0, 0 },
+        { "long UTF-8 strings", 200, 1, 0, 0, 0 },
+        { "escaped long strings", 200, 0, 40, 0, 0 },
+        { "char arrays", 60, 0, 0, 1, 0 },
+        { "short doubles", 6, 0, 0, 0, short_doubles },
+        { "doubles", 18, 0, 0, 0, doubles },
+        { "floats", 9, 0, 0, 0, floats },
+        { "longs", 10, 0, 0, 0, longs },
+    };
+    flatcc_builder_t builder, *B;
+    size_t i, out_size = 4 * DOC_SIZE;
+    char *out;
+    int ret = 0;
+
+    (void)argc;
+    (void)argv;
+
+    if (!(out = malloc(out_size))) {
+        printf("ABORT ON ALLOCATION FAILURE\n");
+        return -1;
+    }
+    B = &builder;
+    flatcc_builder_init(B);
+
+    printf("----\n");
+    for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]) && !ret; ++i) {
+        ret = bench(B, &shapes[i], out, out_size);
+    }
+    printf("----\n");
+    flatcc_builder_clear(B);
+    free(out);
+    return ret;
+}
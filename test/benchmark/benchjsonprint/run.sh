@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchjsonprint
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}
+rm -rf ${TMP}/*
+bin/flatcc --json-printer -a -o ${TMP} test/benchmark/schema/jsonprintbench.fbs
+
+CC=${CC:-cc}
+cp -r test/benchmark/benchjsonprint/* ${TMP}
+cd ${TMP}
+$CC -g -std=c11 -I ${ROOT}/include benchjsonprint.c \
+    ${ROOT}/lib/libflatccrt_d.a -o benchjsonprint_d
+$CC -O3 -DNDEBUG -std=c11 -I ${ROOT}/include benchjsonprint.c \
+    ${ROOT}/lib/libflatccrt.a -o benchjsonprint
+echo "running flatcc json printer benchmark for C (debug)"
+./benchjsonprint_d
+echo "running flatcc json printer benchmark for C (optimized)"
+./benchjsonprint
@@ -0,0 +1,255 @@
+/*
+ * Verifier throughput across buffer shapes that stress different parts
+ * of the verifier. Each shape is built into a separate buffer with the
+ * same root type and verified repeatedly with `Root_verify_as_root`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "verifybench_builder.h"
+#include "verifybench_verifier.h"
+#include "flatcc/support/elapsed.h"
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(benchverify, x)
+
+#undef nsc
+#define nsc(x) FLATBUFFERS_WRAP_NAMESPACE(flatbuffers, x)
+
+/* Approximate number of bytes verified per shape. */
+#define BENCH_VOLUME 100000000
+/* Small buffers can be slow to verify, notably the DAG. */
+#define BENCH_MAX_REP 10000
+
+/* Below the default verifier limit of 100 levels. */
+#define DEEP_LEVELS 60
+#define DEEP_CHAINS 200
+#define WIDE_TABLES 1000
+#define STRING_COUNT 20000
+#define SHAPE_COUNT 10000
+#define SHARED_REFS 100
+
+typedef int build_f(flatcc_builder_t *B);
+
+static ns(Node_ref_t) create_chain(flatcc_builder_t *B, int levels)
+{
+    ns(Node_ref_t) ref = 0;
+    int i;
+
+    for (i = 0; i < levels; ++i) {
+        ns(Node_start(B));
+        if (ref) {
+            ns(Node_child_add(B, ref));
+        }
+        ns(Node_value_add(B, i));
+        ref = ns(Node_end(B));
+    }
+    return ref;
+}
+
+static int build_deep(flatcc_builder_t *B)
+{
+    int i;
+
+    ns(Root_deep_start(B));
+    for (i = 0; i < DEEP_CHAINS; ++i) {
+        ns(Root_deep_push(B, create_chain(B, DEEP_LEVELS)));
+    }
+    return ns(Root_deep_end(B));
+}
+
+#define WIDE_GROUP(B, x, v) \
+    ns(Wide_ ## x ## 0_add(B, v)); ns(Wide_ ## x ## 1_add(B, v)); \
+    ns(Wide_ ## x ## 2_add(B, v)); ns(Wide_ ## x ## 3_add(B, v)); \
+    ns(Wide_ ## x ## 4_add(B, v)); ns(Wide_ ## x ## 5_add(B, v)); \
+    ns(Wide_ ## x ## 6_add(B, v)); ns(Wide_ ## x ## 7_add(B, v));
+
+static int build_wide(flatcc_builder_t *B)
+{
+    int i;
+
+    ns(Root_wide_start(B));
+    for (i = 0; i < WIDE_TABLES; ++i) {
+        ns(Root_wide_push_start(B));
+        WIDE_GROUP(B, a, i + 1)
+        WIDE_GROUP(B, b, i + 1)
+        WIDE_GROUP(B, c, i + 0.5)
+        WIDE_GROUP(B, d, (uint8_t)(i + 1))
+        WIDE_GROUP(B, s, nsc(string_create_str(B, "wide")))
+        ns(Root_wide_push_end(B));
+    }
+    return ns(Root_wide_end(B));
+}
+
+static int build_strings(flatcc_builder_t *B)
+{
+    char s[32];
+    int i;
+
+    ns(Root_strings_start(B));
+    for (i = 0; i < STRING_COUNT; ++i) {
+        sprintf(s, "string number %d", i);
+        ns(Root_strings_push_create_str(B, s));
+    }
+    return ns(Root_strings_end(B));
+}
+
+static int build_shapes(flatcc_builder_t *B)
+{
+    int i;
+
+    ns(Root_shapes_start(B));
+    for (i = 0; i < SHAPE_COUNT; ++i) {
+        switch (i % 3) {
+        case 0:
+            ns(Root_shapes_Point_push_create(B, (float)i, (float)-i));
+            break;
+        case 1:
+            ns(Root_shapes_Text_push_start(B));
+            ns(Text_text_create_str(B, "union text"));
+            ns(Root_shapes_Text_push_end(B));
+            break;
+        default:
+            ns(Root_shapes_Node_push(B, create_chain(B, 3)));
+            break;
+        }
+    }
+    return ns(Root_shapes_end(B));
+}
+
+static int build_nested(flatcc_builder_t *B)
+{
+    int i, j;
+
+    /* Nested buffers of nested buffers, each holding some data. */
+    for (i = 0; i < 10; ++i) {
+        ns(Root_nested_start_as_root(B));
+        ns(Root_strings_start(B));
+        for (j = 0; j < STRING_COUNT / 10; ++j) {
+            ns(Root_strings_push_create_str(B, "nested string"));
+        }
+        ns(Root_strings_end(B));
+        ns(Root_deep_start(B));
+        ns(Root_deep_push(B, create_chain(B, 10)));
+        ns(Root_deep_end(B));
+    }
+    for (i = 0; i < 10; ++i) {
+        ns(Root_nested_end_as_root(B));
+    }
+    return 0;
+}
+
+static int build_shared(flatcc_builder_t *B)
+{
+    ns(Node_ref_t) ref;
+    int i;
+
+    /* A DAG: every element references the same chain. */
+    ref = create_chain(B, DEEP_LEVELS);
+    ns(Root_shared_start(B));
+    for (i = 0; i < SHARED_REFS; ++i) {
+        ns(Root_shared_push(B, ref));
+    }
+    return ns(Root_shared_end(B));
+}
+
+static void *create_buffer(flatcc_builder_t *B, build_f *build, size_t *size)
+{
+    flatcc_builder_reset(B);
+    ns(Root_start_as_root(B));
+    build(B);
+    ns(Root_end_as_root(B));
+    return flatcc_builder_finalize_aligned_buffer(B, size);
+}
+
+static int bench(const char *shape, void *buf, size_t size, flatcc_verify_visited_t *visited)
+{
+    char title[100];
+    double t1, t2;
+    int i, rep, ret = 0;
+
+    rep = (int)(BENCH_VOLUME / size) + 1;
+    rep = rep > BENCH_MAX_REP ? BENCH_MAX_REP : rep;
+    if (visited) {
+        flatcc_verify_visited_reset(visited);
+        ret = ns(Root_verify_as_root_with_visited(buf, size, visited));
+    } else {
+        ret = ns(Root_verify_as_root(buf, size));
+    }
+    if (ret) {
+        printf("ABORT ON VERIFY FAILURE: %s: %s\n", shape, flatcc_verify_error_string(ret));
+        return -1;
+    }
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        if (visited) {
+            flatcc_verify_visited_reset(visited);
+            ret |= ns(Root_verify_as_root_with_visited(buf, size, visited));
+        } else {
+            ret |= ns(Root_verify_as_root(buf, size));
+        }
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON VERIFY FAILURE: %s\n", shape);
+        return -1;
+    }
+    sprintf(title, "flatcc verify %s%s " COMPILE_TYPE, shape, visited ? " with visited set" : "");
+    show_benchmark(title, t1, t2, size, rep, 0);
+    printf("\n");
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *shape;
+        build_f *build;
+    } shapes[] = {
+        { "deep nesting", build_deep },
+        { "wide tables", build_wide },
+        { "string vector", build_strings },
+        { "union vector", build_shapes },
+        { "nested flatbuffers", build_nested },
+        { "shared subtree DAG", build_shared },
+    };
+    static struct flatcc_verify_visited_item items[1024];
+    flatcc_verify_visited_t visited;
+    flatcc_builder_t builder, *B;
+    void *buf;
+    size_t size, i;
+    int ret = 0;
+
+    (void)argc;
+    (void)argv;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    flatcc_verify_visited_init(&visited, items, sizeof(items) / sizeof(items[0]));
+
+    printf("----\n");
+    for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]) && !ret; ++i) {
+        buf = create_buffer(B, shapes[i].build, &size);
+        if (!buf) {
+            printf("ABORT ON BUILD FAILURE: %s\n", shapes[i].shape);
+            ret = -1;
+            break;
+        }
+        ret = bench(shapes[i].shape, buf, size, 0);
+        if (!ret && shapes[i].build == build_shared) {
+            ret = bench(shapes[i].shape, buf, size, &visited);
+        }
+        flatcc_builder_aligned_free(buf);
+    }
+    printf("----\n");
+    flatcc_builder_clear(B);
+    return ret;
+}
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchverify
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}
+rm -rf ${TMP}/*
+bin/flatcc -a -o ${TMP} test/benchmark/schema/verifybench.fbs
+
+CC=${CC:-cc}
+cp -r test/benchmark/benchverify/* ${TMP}
+cd ${TMP}
+$CC -g -std=c11 -I ${ROOT}/include benchverify.c \
+    ${ROOT}/lib/libflatccrt_d.a -o benchverify_d
+$CC -O3 -DNDEBUG -std=c11 -I ${ROOT}/include benchverify.c \
+    ${ROOT}/lib/libflatccrt.a -o benchverify
+echo "running flatcc verifier benchmark for C (debug)"
+./benchverify_d
+echo "running flatcc verifier benchmark for C (optimized)"
+./benchverify
@@ -45,8 +45,12 @@ static const struct test_scope Movie = {
     nsf(Movie_verify_table)
 };
 
+/*
+ * When `expect_line` is not 0, an expected error must also be reported
+ * at `expect_line` and `expect_pos`.
+ */
 int test_json(const struct test_scope *scope, char *json,
-        char *expect, int expect_err,
+        char *expect, int expect_err, int expect_line, int expect_pos,
         flatcc_json_parser_flags_t parse_flags, flatcc_json_printer_flags_t print_flags, int line)
 {
     int ret = -1;
@@ -89,6 +93,13 @@ int test_json(const struct test_scope *scope, char *json,
         goto failed;
     }
     if (expect_err) {
+        if (expect_line && (parser_ctx.line != expect_line || parser_ctx.pos != expect_pos)) {
+            fprintf(stderr, "%d: json test: parse failed with: %s at %d:%d\n",
+                    line, flatcc_json_parser_error_string(err), parser_ctx.line, parser_ctx.pos);
+            fprintf(stderr, "but expected: %s at %d:%d\n",
+                    flatcc_json_parser_error_string(expect_err), expect_line, expect_pos);
+            goto failed;
+        }
         ret = 0;
         goto done;
     }
@@ -128,16 +139,20 @@ failed:
 #define END_TEST() return ret;
 
 #define TEST(x, y) \
-    ret |= test_json(scope, (x), (y), 0, 0, 0, __LINE__);
+    ret |= test_json(scope, (x), (y), 0, 0, 0, 0, 0, __LINE__);
 
 #define TEST_ERROR(x, err) \
-    ret |= test_json(scope, (x), 0, err, 0, 0, __LINE__);
+    ret |= test_json(scope, (x), 0, err, 0, 0, 0, 0, __LINE__);
+
+/* Also checks the error location. */
+#define TEST_ERROR_AT(x, err, line, pos) \
+    ret |= test_json(scope, (x), 0, err, (line), (pos), 0, 0, __LINE__);
 
 #define TEST_FLAGS(fparse, fprint, x, y) \
-    ret |= test_json(scope, (x), (y), 0, (fparse), (fprint), __LINE__);
+    ret |= test_json(scope, (x), (y), 0, 0, 0, (fparse), (fprint), __LINE__);
 
 #define TEST_ERROR_FLAGS(fparse, fprint, x, err) \
-    ret |= test_json(scope, (x), 0, err, (fparse), (fprint), __LINE__);
+    ret |= test_json(scope, (x), 0, err, 0, 0, (fparse), (fprint), __LINE__);
 
 int edge_case_tests(void)
 {
@@ -425,6 +440,73 @@ int base64_tests(void)
     END_TEST();
 }
 
+/* Independent of pbase64.h so vectorized encoding and decoding is checked. */
+static size_t reference_base64(char *dst, const uint8_t *src, size_t len, int url, int pad)
+{
+    const char *T = url ?
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char *p = dst;
+    uint32_t x;
+    size_t i, k;
+
+    for (i = 0; i < len; i += 3) {
+        k = len - i < 3 ? len - i : 3;
+        x = (uint32_t)src[i] << 16;
+        x |= k > 1 ? (uint32_t)src[i + 1] << 8 : 0;
+        x |= k > 2 ? (uint32_t)src[i + 2] : 0;
+        *p++ = T[(x >> 18) & 63];
+        *p++ = T[(x >> 12) & 63];
+        *p++ = k > 1 ? T[(x >> 6) & 63] : '=';
+        *p++ = k > 2 ? T[x & 63] : '=';
+        if (!pad) {
+            p -= 3 - k;
+        }
+    }
+    *p = '\0';
+    return (size_t)(p - dst);
+}
+
+/*
+ * Payloads long enough for the vectorized whole blocks with every
+ * tail length, and errors placed inside a whole block.
+ */
+int large_base64_tests(void)
+{
+    static const size_t sizes[] = { 23, 24, 25, 47, 48, 49, 71, 72, 73, 95, 96, 97, 1000, 20001 };
+    static const char *fields[] = { "data", "urldata" };
+    static uint8_t data[20001];
+    static char encoded[30000], json[30100], expect[30100];
+    size_t i, j, n, len;
+    int url;
+
+    BEGIN_TEST(Monster);
+
+    for (i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t)((i * 2654435761u) >> 13);
+    }
+    for (url = 0; url < 2; ++url) {
+        for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+            n = sizes[i];
+            reference_base64(encoded, data, n, url, 1);
+            sprintf(expect, "{\"name\":\"Monster\",\"testbase64\":{\"%s\":\"%s\"}}", fields[url], encoded);
+            sprintf(json, "{ \"name\": \"Monster\", \"testbase64\":{ \"%s\":\"%s\"} }", fields[url], encoded);
+            TEST(json, expect);
+            len = reference_base64(encoded, data, n, url, 0);
+            sprintf(json, "{ \"name\": \"Monster\", \"testbase64\":{ \"%s\":\"%s\"} }", fields[url], encoded);
+            TEST(json, expect);
+            /* The symbols of the other alphabet, or a space, are not accepted. */
+            for (j = 0; j < 3; ++j) {
+                reference_base64(encoded, data, n, url, 0);
+                encoded[len - 17 + j] = j == 0 ? ' ' : j == 1 ? (url ? '+' : '-') : (url ? '/' : '_');
+                sprintf(json, "{ \"name\": \"Monster\", \"testbase64\":{ \"%s\":\"%s\"} }", fields[url], encoded);
+                TEST_ERROR(json, url ? flatcc_json_parser_error_base64url : flatcc_json_parser_error_base64);
+            }
+        }
+    }
+    END_TEST();
+}
+
 int mixed_type_union_tests(void)
 {
     BEGIN_TEST(Movie);
@@ -574,6 +656,994 @@ int fixed_array_tests(void)
     END_TEST();
 }
 
+/*
+ * Strings and space runs long enough to be scanned in vector blocks
+ * with the terminating byte placed before, on, and after block
+ * boundaries.
+ */
+#define LONG_32 "0123456789abcdef0123456789ABCDEF"
+#define LONG_64 LONG_32 LONG_32
+#define BACKSLASH_4 "\\\\\\\\"
+#define BACKSLASH_20 BACKSLASH_4 BACKSLASH_4 BACKSLASH_4 BACKSLASH_4 BACKSLASH_4
+#define SPACE_32 "    \t           \t               "
+
+int long_string_tests(void)
+{
+    char json[400], expect[400];
+    int i;
+
+    BEGIN_TEST(Monster);
+
+    /* Escapes and UTF-8 at every offset within and across scan blocks. */
+    for (i = 0; i < 140; ++i) {
+        sprintf(json, "{ \"name\": \"%.*s\\t" LONG_64 "\\u00e6\\\"%.*s\\u0001\" }",
+                i, LONG_64 LONG_64 LONG_64, i % 70, LONG_64 LONG_64);
+        sprintf(expect, "{\"name\":\"%.*s\\t" LONG_64 "\xc3\xa6\\\"%.*s\\u0001\"}",
+                i, LONG_64 LONG_64 LONG_64, i % 70, LONG_64 LONG_64);
+        TEST(json, expect);
+    }
+
+    TEST(   "{ \"name\": \"" LONG_64 LONG_64 "\" }",
+            "{\"name\":\"" LONG_64 LONG_64 "\"}");
+    TEST(   "{ \"name\": \"" LONG_64 "\\n" LONG_32 "x\" }",
+            "{\"name\":\"" LONG_64 "\\n" LONG_32 "x\"}");
+    TEST(   "{ \"name\": \"" LONG_32 "0123456789abcde\\\"" LONG_64 "\" }",
+            "{\"name\":\"" LONG_32 "0123456789abcde\\\"" LONG_64 "\"}");
+    TEST(   "{ \"name\": \"" LONG_32 BACKSLASH_20 "\\\"" LONG_32 "\" }",
+            "{\"name\":\"" LONG_32 BACKSLASH_20 "\\\"" LONG_32 "\"}");
+    TEST(   "{ \"name\": \"" LONG_32 "\\u00e6" LONG_32 "\" }",
+            "{\"name\":\"" LONG_32 "\xc3\xa6" LONG_32 "\"}");
+    TEST(   "{" SPACE_32 SPACE_32 SPACE_32 "\"name\"" SPACE_32 ":" SPACE_32 SPACE_32
+            "\"Monster\"\n" SPACE_32 SPACE_32 "\n" SPACE_32 "}",
+            "{\"name\":\"Monster\"}");
+    TEST_ERROR( "{ \"name\": \"" LONG_32 "\x01" LONG_64 "\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"" LONG_64 "0123456789\n" LONG_32 "\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"" LONG_64 LONG_64 LONG_32,
+            flatcc_json_parser_error_unterminated_string );
+
+    END_TEST();
+}
+
+int long_char_array_tests(void)
+{
+    char json[400], expect[400];
+    int i;
+
+    BEGIN_TEST(Alt);
+
+    /* Escapes at every offset within and across print scan blocks. */
+    for (i = 0; i < 100; ++i) {
+        sprintf(json, "{ \"long_text\": { \"text\": \"%.*s\\t%.*s\\\"\\u0001\" } }",
+                i, LONG_64 LONG_64, i % 48, LONG_64);
+        sprintf(expect, "{\"long_text\":{\"id\":0,\"text\":\"%.*s\\t%.*s\\\"\\u0001\"}}",
+                i, LONG_64 LONG_64, i % 48, LONG_64);
+        TEST(json, expect);
+    }
+
+    TEST(   "{ \"long_text\": { \"text\": \"" LONG_64 LONG_64 LONG_32 "\" } }",
+            "{\"long_text\":{\"id\":0,\"text\":\"" LONG_64 LONG_64 LONG_32 "\"}}");
+    TEST(   "{ \"long_text\": { \"text\": \"" LONG_64 LONG_32 BACKSLASH_20 "\" } }",
+            "{\"long_text\":{\"id\":0,\"text\":\"" LONG_64 LONG_32 BACKSLASH_20 "\"}}");
+
+    END_TEST();
+}
+
+struct ndjson_output {
+    const struct test_scope *scope;
+    char text[1000];
+    size_t len;
+};
+
+/* Verifies each size prefixed buffer and prints it as a line. */
+static int ndjson_emit(void *emit_context, const void *buf, size_t bufsiz)
+{
+    struct ndjson_output *out = emit_context;
+    const struct test_scope *scope = out->scope;
+    flatcc_json_printer_t printer_ctx;
+    void *p;
+    size_t size;
+    char *json;
+    int ret = -1;
+
+    /* Emitter pages need not be aligned as the verifier expects. */
+    if (!(p = flatcc_builder_aligned_alloc(16, bufsiz))) {
+        return -1;
+    }
+    memcpy(p, buf, bufsiz);
+    if ((ret = flatcc_verify_table_as_root_with_size(p, bufsiz, scope->identifier, scope->verifier))) {
+        fprintf(stderr, "ndjson test: buffer verification failed: %s\n",
+                flatcc_verify_error_string(ret));
+        goto done;
+    }
+    flatcc_json_printer_init_dynamic_buffer(&printer_ctx, 0);
+    flatcc_json_printer_table_as_root(&printer_ctx, (char *)p + sizeof(flatbuffers_uoffset_t),
+            bufsiz - sizeof(flatbuffers_uoffset_t), scope->identifier, scope->printer);
+    json = flatcc_json_printer_get_buffer(&printer_ctx, &size);
+    if (json && out->len + size + 1 < sizeof(out->text)) {
+        memcpy(out->text + out->len, json, size);
+        out->len += size;
+        out->text[out->len++] = '\n';
+        out->text[out->len] = '\0';
+        ret = 0;
+    }
+    flatcc_json_printer_clear(&printer_ctx);
+done:
+    flatcc_builder_aligned_free(p);
+    return ret;
+}
+
+int test_ndjson(const struct test_scope *scope, const char *json, size_t parts,
+        const char *expect, size_t expect_count, int expect_err, int expect_line, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t ctx;
+    struct ndjson_output out;
+    size_t offsets[11], i, n, count, total = 0;
+    int err = 0;
+
+    memset(&out, 0, sizeof(out));
+    out.scope = scope;
+    flatcc_builder_init(&builder);
+    /* Only `parts + 1` offsets may be written. */
+    offsets[parts + 1] = (size_t)-1;
+    n = flatcc_json_parser_ndjson_split(json, strlen(json), parts, offsets);
+    for (i = 0; i < n && !err; ++i) {
+        err = flatcc_json_parser_ndjson(&builder, &ctx, json + offsets[i], offsets[i + 1] - offsets[i],
+                0, scope->identifier, scope->parser, ndjson_emit, &out, &count);
+        total += count;
+    }
+    flatcc_builder_clear(&builder);
+    if (n > parts || offsets[n] != strlen(json) || (n && offsets[0] != 0) || offsets[parts + 1] != (size_t)-1) {
+        fprintf(stderr, "%d: ndjson test: invalid split into %d ranges\n", line, (int)n);
+        return -1;
+    }
+    if (err != expect_err || (err && ctx.line != expect_line)) {
+        fprintf(stderr, "%d: ndjson test: parse failed with: %s at line %d\n",
+                line, flatcc_json_parser_error_string(err), err ? ctx.line : 0);
+        fprintf(stderr, "but expected: %s at line %d\n",
+                flatcc_json_parser_error_string(expect_err), expect_line);
+        return -1;
+    }
+    if (total != expect_count || strcmp(out.text, expect)) {
+        fprintf(stderr, "%d: ndjson test: got %d buffers:\n%s", line, (int)total, out.text);
+        fprintf(stderr, "expected %d buffers:\n%s", (int)expect_count, expect);
+        return -1;
+    }
+    return 0;
+}
+
+#define TEST_NDJSON(x, parts, y, count, err, line) \
+    ret |= test_ndjson(scope, (x), (parts), (y), (count), (err), (line), __LINE__);
+
+#define NDJSON_INPUT                                                        \
+    "{\"name\":\"a\"}\n"                                                    \
+    "\n"                                                                    \
+    "  \r\n"                                                                \
+    "{ \"name\": \"b\", \"hp\": 10 }\r\n"                                   \
+    "{\"name\":\"c\"}\n"                                                    \
+    "{\"name\":\"d\"}"
+
+#define NDJSON_OUTPUT                                                       \
+    "{\"name\":\"a\"}\n"                                                    \
+    "{\"hp\":10,\"name\":\"b\"}\n"                                          \
+    "{\"name\":\"c\"}\n"                                                    \
+    "{\"name\":\"d\"}\n"
+
+int ndjson_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST_NDJSON("", 1, "", 0, 0, 0);
+    TEST_NDJSON(NDJSON_INPUT, 0, "", 0, 0, 0);
+    TEST_NDJSON("\n \n", 1, "", 0, 0, 0);
+    TEST_NDJSON(NDJSON_INPUT, 1, NDJSON_OUTPUT, 4, 0, 0);
+    /* Ranges split at newlines give the same output in order. */
+    TEST_NDJSON(NDJSON_INPUT, 2, NDJSON_OUTPUT, 4, 0, 0);
+    TEST_NDJSON(NDJSON_INPUT, 3, NDJSON_OUTPUT, 4, 0, 0);
+    TEST_NDJSON(NDJSON_INPUT, 9, NDJSON_OUTPUT, 4, 0, 0);
+    TEST_NDJSON("{\"name\":\"a\"}\n{\"name\":\"b\" \"hp\": 1}\n{\"name\":\"c\"}\n", 1,
+            "{\"name\":\"a\"}\n", 1, flatcc_json_parser_error_unbalanced_object, 2);
+    /* A line holds exactly one table. */
+    TEST_NDJSON("\n\n{\"name\":\"a\"} {\"name\":\"b\"}\n", 1,
+            "", 0, flatcc_json_parser_error_unexpected_character, 3);
+
+    END_TEST();
+}
+
+struct record_output {
+    char text[1000];
+    size_t len;
+    int lines;
+    int writes;
+    int syncs;
+};
+
+/* Counts writes and the lines completed by the time of each write. */
+static int record_write(void *write_context, const char *data, size_t len)
+{
+    struct record_output *out = write_context;
+
+    if (!data) {
+        ++out->syncs;
+        return 0;
+    }
+    if (out->len + len + 1 > sizeof(out->text)) {
+        return -1;
+    }
+    memcpy(out->text + out->len, data, len);
+    out->len += len;
+    out->text[out->len] = '\0';
+    out->lines += len && data[len - 1] == '\n';
+    ++out->writes;
+    return 0;
+}
+
+/*
+ * Prints `testarrayoftables` of the root table as NDJSON through a
+ * writer which must receive each line as soon as it is printed. Compact
+ * output must parse back to the same lines.
+ */
+int test_print_ndjson(const struct test_scope *scope, const char *json, flatcc_json_printer_flags_t flags,
+        const char *expect, int expect_lines, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_printer_t printer_ctx;
+    struct record_output out;
+    void *flatbuffer = 0;
+    size_t size;
+    int ret = -1;
+
+    memset(&out, 0, sizeof(out));
+    flatcc_builder_init(&builder);
+    if (ns(Monster_parse_json_as_root(&builder, 0, json, strlen(json), 0, 0))) {
+        fprintf(stderr, "%d: ndjson print test: parse failed\n", line);
+        goto done;
+    }
+    flatbuffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+    flatcc_json_printer_init_writer(&printer_ctx, record_write, &out, 0);
+    flatcc_json_printer_set_flags(&printer_ctx, flags);
+    if (ns(Monster_testarrayoftables_print_ndjson(&printer_ctx, flatbuffer, size, 0)) < 0) {
+        fprintf(stderr, "%d: ndjson print test: print failed with: %s\n",
+                line, flatcc_json_printer_error_string(flatcc_json_printer_get_error(&printer_ctx)));
+        goto done;
+    }
+    if (strcmp(out.text, expect) || out.lines != expect_lines) {
+        fprintf(stderr, "%d: ndjson print test: got %d lines:\n%s", line, out.lines, out.text);
+        fprintf(stderr, "expected %d lines:\n%s", expect_lines, expect);
+        goto done;
+    }
+    if (out.writes != expect_lines || out.syncs != expect_lines) {
+        fprintf(stderr, "%d: ndjson print test: %d writes and %d syncs for %d lines\n",
+                line, out.writes, out.syncs, expect_lines);
+        goto done;
+    }
+    if (flatcc_json_printer_get_level(&printer_ctx) != 0) {
+        fprintf(stderr, "%d: ndjson print test: indentation level not restored\n", line);
+        goto done;
+    }
+    if (flags == 0) {
+        ret = test_ndjson(scope, out.text, 1, out.text, (size_t)expect_lines, 0, 0, line);
+    } else {
+        ret = 0;
+    }
+done:
+    flatcc_json_printer_clear(&printer_ctx);
+    flatcc_builder_aligned_free(flatbuffer);
+    flatcc_builder_clear(&builder);
+    return ret;
+}
+
+#define TEST_PRINT_NDJSON(x, fprint, y, lines) \
+    ret |= test_print_ndjson(scope, (x), (fprint), (y), (lines), __LINE__);
+
+int ndjson_print_tests(void)
+{
+    const char *json = "{ \"name\": \"root\", \"hp\": 1, \"testarrayoftables\": ["
+            "{ \"name\": \"a\" }, { \"name\": \"b\", \"hp\": 10, \"color\": \"Red\" },"
+            "{ \"name\": \"c\", \"testarrayoftables\": [{ \"name\": \"d\" }, { \"name\": \"e\" }] }] }";
+
+    BEGIN_TEST(Monster);
+
+    TEST_PRINT_NDJSON(json, 0,
+            "{\"name\":\"a\"}\n"
+            "{\"hp\":10,\"name\":\"b\",\"color\":\"Red\"}\n"
+            "{\"name\":\"c\",\"testarrayoftables\":[{\"name\":\"d\"},{\"name\":\"e\"}]}\n",
+            3);
+    /* Lines are compact regardless of indentation. */
+    TEST_PRINT_NDJSON(json, flatcc_json_printer_f_nonstrict,
+            "{name:\"a\"}\n"
+            "{hp:10,name:\"b\",color:Red}\n"
+            "{name:\"c\",testarrayoftables:[{name:\"d\"},{name:\"e\"}]}\n",
+            3);
+    TEST_PRINT_NDJSON("{ \"name\": \"root\" }", 0, "", 0);
+    TEST_PRINT_NDJSON("{ \"name\": \"root\", \"testarrayoftables\": [] }", 0, "", 0);
+
+    END_TEST();
+}
+
+int test_union_reparses(const struct test_scope *scope, const char *json,
+        size_t expect_reparses, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t ctx;
+    int err;
+
+    flatcc_builder_init(&builder);
+    err = flatcc_json_parser_table_as_root(&builder, &ctx, json, strlen(json), 0,
+            scope->identifier, scope->parser);
+    flatcc_builder_clear(&builder);
+    if (err || ctx.stats.union_reparses != expect_reparses) {
+        fprintf(stderr, "%d: union reparse test: got %d reparses (%s), expected %d\n",
+                line, (int)ctx.stats.union_reparses,
+                flatcc_json_parser_error_string(err), (int)expect_reparses);
+        return -1;
+    }
+    return 0;
+}
+
+#define TEST_UNION_REPARSES(x, reparses) \
+    ret |= test_union_reparses(scope, (x), (reparses), __LINE__);
+
+/*
+ * Union values before their type are parsed speculatively as each
+ * table member type, or skipped a block at a time and parsed when the
+ * type is known.
+ */
+int union_skip_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST(   "{ \"test\": {\n  \"name\": \"" LONG_64 "\",\r\n  \"testarrayofstring\": [ \"]}\\\"{[\" ]\n},\n"
+            "\"test_type\": \"Monster\", \"name\": \"Monster\" }",
+            "{\"name\":\"Monster\",\"test_type\":\"Monster\",\"test\":{\"name\":\"" LONG_64 "\","
+            "\"testarrayofstring\":[\"]}\\\"{[\"]}}");
+    TEST(   "{ \"test\": { \"test\": { \"name\": \"inner\" }, \"test_type\": \"Monster\", \"name\": \"" LONG_32 "\" },"
+            " \"test_type\": \"Monster\", \"name\": \"Monster\" }",
+            "{\"name\":\"Monster\",\"test_type\":\"Monster\",\"test\":{\"name\":\"" LONG_32 "\","
+            "\"test_type\":\"Monster\",\"test\":{\"name\":\"inner\"}}}");
+    /* Lines are counted in the skipped value. */
+    TEST_ERROR_AT("{ \"test\": {\n\"name\": \"" LONG_64 "\"\r\n}, \"hp\": \"x\","
+            " \"test_type\": \"Monster\" }", flatcc_json_parser_error_expected_scalar, 3, 11);
+    TEST_ERROR_AT("{ \"test\": {\r\r\"name\": \"" LONG_64 "\"\n\n}\n, \"hp\": \"x\",",
+            flatcc_json_parser_error_expected_scalar, 6, 10);
+    /* Errors in the skipped value are found when it is parsed. */
+    TEST_ERROR_AT("{ \"test\": {\n\"name\" \"" LONG_64 "\"\n},\n\"test_type\": \"Monster\" }",
+            flatcc_json_parser_error_expected_colon, 2, 8);
+    TEST_ERROR_AT("{ \"test\": {\n\"name\": \"\x01\" },\n\"test_type\": \"Monster\" }",
+            flatcc_json_parser_error_invalid_character, 2, 10);
+    TEST_ERROR_AT("{ \"test\": {\n\"name\": \"" LONG_64 " }",
+            flatcc_json_parser_error_unterminated_string, 2, 76);
+    TEST_ERROR( "{ \"test\": { \"name\": \"" LONG_64 "\" }, \"test_type\": \"NONE\", \"name\": \"Monster\" }",
+            flatcc_json_parser_error_union_none_not_null);
+    TEST_ERROR( "{ \"test\": { \"name\": \"" LONG_64 "\" }, \"name\": \"Monster\" }",
+            flatcc_json_parser_error_union_incomplete);
+    /* The speculative table is kept when the type matches a later member. */
+    TEST(   "{ \"test\": { \"color\": \"Red\" }, \"test_type\": \"TestSimpleTableWithEnum\", \"name\": \"M\" }",
+            "{\"name\":\"M\",\"test_type\":\"TestSimpleTableWithEnum\",\"test\":{\"color\":\"Red\"}}");
+    /* Reparsed when the type differs from the member that parsed. */
+    TEST(   "{ \"test\": {}, \"test_type\": \"Monster2\", \"name\": \"M\" }",
+            "{\"name\":\"M\",\"test_type\":\"Monster2\",\"test\":{}}");
+    /* A failed member leaves nested tables and union frames behind. */
+    TEST_FLAGS(flatcc_json_parser_f_skip_unknown, 0,
+            "{ \"test\": { \"color\": \"Red\", \"test\": { \"name\": \"in\" }, \"test_type\": \"Monster\","
+            " \"enemy\": { \"name\": \"e\", \"hp\": \"x\" } }, \"test_type\": \"TestSimpleTableWithEnum\","
+            " \"name\": \"M\" }",
+            "{\"name\":\"M\",\"test_type\":\"TestSimpleTableWithEnum\",\"test\":{\"color\":\"Red\"}}");
+    TEST_UNION_REPARSES("{ \"test\": { \"name\": \"a\" }, \"test_type\": \"Monster\", \"name\": \"b\" }", 0);
+    TEST_UNION_REPARSES("{ \"test\": { \"color\": \"Red\" }, \"test_type\": \"TestSimpleTableWithEnum\","
+            " \"name\": \"b\" }", 0);
+    TEST_UNION_REPARSES("{ \"test\": {}, \"test_type\": \"Monster2\", \"name\": \"b\" }", 1);
+    /* Union values inside a speculative parse are not speculated on. */
+    TEST_UNION_REPARSES("{ \"test\": { \"test\": { \"name\": \"c\" }, \"test_type\": \"Monster\", \"name\": \"a\" },"
+            " \"test_type\": \"Monster\", \"name\": \"b\" }", 1);
+    TEST_ERROR_AT("{ \"test\": { \"name\": \"a\",\n \"enemy\": { \"name\": \"e\" }, \"nosuch\": 1 },\n"
+            " \"test_type\": \"Monster\", \"name\": \"M\" }", flatcc_json_parser_error_unknown_symbol, 2, 29);
+
+    END_TEST();
+}
+
+int union_vector_skip_tests(void)
+{
+    BEGIN_TEST(Alt);
+
+    TEST(   "{\"manyany\": [{\"name\": \"" LONG_64 "\"},\n null, {\"name\": \"[\"}],"
+            " \"manyany_type\": [ \"Monster\", \"NONE\", \"Monster\" ] }",
+            "{\"manyany_type\":[\"Monster\",\"NONE\",\"Monster\"],"
+            "\"manyany\":[{\"name\":\"" LONG_64 "\"},null,{\"name\":\"[\"}]}");
+    TEST_ERROR( "{\"manyany\": [{\"name\": \"" LONG_64 "\"}], \"manyany_type\": [ \"Monster\", \"NONE\" ] }",
+            flatcc_json_parser_error_union_vector_length);
+
+    END_TEST();
+}
+
+/*
+ * Long numbers exercise 8 digit conversion and the Eisel-Lemire fast
+ * path, and the rest falls back to the general double parser.
+ */
+int number_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST(   "{ \"name\": \"Monster\", \"testhashu64_fnv1\": 18446744073709551615 }",
+            "{\"name\":\"Monster\",\"testhashu64_fnv1\":18446744073709551615}");
+    TEST(   "{ \"name\": \"Monster\", \"testhashs64_fnv1\": -9223372036854775808 }",
+            "{\"name\":\"Monster\",\"testhashs64_fnv1\":-9223372036854775808}");
+    TEST(   "{ \"name\": \"Monster\", \"testhashs32_fnv1\": -12345678, \"testhashu32_fnv1\": 1234567 }",
+            "{\"name\":\"Monster\",\"testhashs32_fnv1\":-12345678,\"testhashu32_fnv1\":1234567}");
+    TEST_ERROR("{ \"name\": \"Monster\", \"hp\": 12345678 }",
+            flatcc_json_parser_error_overflow);
+    TEST_ERROR("{ \"name\": \"Monster\", \"testhashu64_fnv1\": 18446744073709551616 }",
+            flatcc_json_parser_error_overflow);
+    /* Wraps around to a larger value in a naive overflow check. */
+    TEST_ERROR("{ \"name\": \"Monster\", \"testhashu64_fnv1\": 30000000000000000000 }",
+            flatcc_json_parser_error_overflow);
+    TEST_ERROR("{ \"name\": \"Monster\", \"testhashs64_fnv1\": -30000000000000000000 }",
+            flatcc_json_parser_error_underflow);
+    TEST_ERROR("{ \"name\": \"Monster\", \"testhashu64_fnv1\": 123456789.5 }",
+            flatcc_json_parser_error_float_unexpected);
+    TEST(   "{ \"name\": \"Monster\", \"vector_of_doubles\": [0.1, -2.5e-3, 3.14159265358979, "
+            "1.7976931348623157e308, 2.2250738585072014e-308, 9007199254740993, "
+            "0.000000000000000000001234567890123456789] }",
+            "{\"name\":\"Monster\",\"vector_of_doubles\":[0.1,-0.0025,3.14159265358979,"
+            "17976931348623157e292,2.2250738585072014e-308,9007199254740992,1.2345678901234568e-21]}");
+    /* Too many digits for the fast path, and a subnormal. */
+    TEST(   "{ \"name\": \"Monster\", \"vector_of_doubles\": [123456789012345678901234567890, "
+            "4.9406564584124654e-324, 0.0, -0.0] }",
+            "{\"name\":\"Monster\",\"vector_of_doubles\":[12345678901234568e13,5e-324,0,-0]}");
+#if FLATCC_USE_SCHUBFACH
+    /* Shortest digits where grisu3 falls back to 17 digits. */
+    TEST(   "{ \"name\": \"Monster\", \"vector_of_doubles\": [68.8247, 9.1734, 0.043000000000000003, "
+            "1e23, 5e-1, 123e-7, 1e21, 100] }",
+            "{\"name\":\"Monster\",\"vector_of_doubles\":[68.8247,9.1734,0.043000000000000003,"
+            "1e23,0.5,1.23e-5,1e21,100]}");
+    /* Floats print the shortest digits of the float, not the widened double. */
+    TEST(   "{ \"name\": \"Monster\", \"testf\": 0.1, \"testf2\": 3.4028235e38, \"testf3\": -1e-45 }",
+            "{\"name\":\"Monster\",\"testf\":0.1,\"testf2\":34028235e31,\"testf3\":-1e-45}");
+#endif
+    /* Skipped numbers. */
+    TEST_FLAGS(flatcc_json_parser_f_skip_unknown, 0,
+            "{ \"name\": \"Monster\", \"xhp\": [123456789012345678901234567890, -1.25e-300, 12345678], \"hp\": 42 }",
+            "{\"hp\":42,\"name\":\"Monster\"}");
+
+    END_TEST();
+}
+
+/* Numeric vectors are extended in chunks while elements are plain numbers. */
+int numeric_vector_tests(void)
+{
+    char json[2000], expect[2000];
+    char *p, *q;
+    int i;
+
+    BEGIN_TEST(Monster);
+
+    /* More elements than fit in one chunk. */
+    p = json + sprintf(json, "{ \"name\": \"Monster\", \"inventory\": [");
+    q = expect + sprintf(expect, "{\"name\":\"Monster\",\"inventory\":[");
+    for (i = 0; i < 200; ++i) {
+        p += sprintf(p, "%s%d", i ? ", " : "", i);
+        q += sprintf(q, "%s%d", i ? "," : "", i);
+    }
+    sprintf(p, "] }");
+    sprintf(q, "]}");
+    TEST(json, expect);
+
+    TEST(   "{ \"name\": \"Monster\", \"inventory\": [] }",
+            "{\"name\":\"Monster\",\"inventory\":[]}");
+    TEST(   "{ \"name\": \"Monster\", \"inventory\": [ 1 , 2 , ] }",
+            "{\"name\":\"Monster\",\"inventory\":[1,2]}");
+    /* A symbolic element ends the run and the rest is parsed per element. */
+    TEST(   "{ \"name\": \"Monster\", \"inventory\": [1, 2, \"Color.Green\", 3, 4] }",
+            "{\"name\":\"Monster\",\"inventory\":[1,2,2,3,4]}");
+    TEST(   "{ \"name\": \"Monster\", \"inventory\": [\"Color.Green\", 3, 4] }",
+            "{\"name\":\"Monster\",\"inventory\":[2,3,4]}");
+    TEST(   "{ \"name\": \"Monster\", \"vector_of_longs\": [1, -2, 9223372036854775807, -9223372036854775808] }",
+            "{\"name\":\"Monster\",\"vector_of_longs\":[1,-2,9223372036854775807,-9223372036854775808]}");
+    TEST(   "{ \"name\": \"Monster\", \"vector_of_doubles\": [1, -2.5, 1e10] }",
+            "{\"name\":\"Monster\",\"vector_of_doubles\":[1,-2.5,1e10]}");
+    TEST_ERROR("{ \"name\": \"Monster\", \"inventory\": [1, 2, 300] }",
+            flatcc_json_parser_error_overflow);
+    TEST_ERROR("{ \"name\": \"Monster\", \"inventory\": [1, 2 3] }",
+            flatcc_json_parser_error_unbalanced_array);
+    TEST_ERROR("{ \"name\": \"Monster\", \"vector_of_doubles\": [1, -x] }",
+            flatcc_json_parser_error_invalid_numeric);
+
+    END_TEST();
+}
+
+/* Checks how many strings were created and how many without escapes. */
+int test_string_stats(const struct test_scope *scope, const char *json, int ndjson,
+        size_t expect_strings, size_t expect_direct, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t ctx;
+    const flatcc_json_parser_stats_t *stats;
+    int err;
+
+    flatcc_builder_init(&builder);
+    if (ndjson) {
+        err = flatcc_json_parser_ndjson(&builder, &ctx, json, strlen(json), 0,
+                scope->identifier, scope->parser, 0, 0, 0);
+    } else {
+        err = flatcc_json_parser_table_as_root(&builder, &ctx, json, strlen(json), 0,
+                scope->identifier, scope->parser);
+    }
+    flatcc_builder_clear(&builder);
+    stats = flatcc_json_parser_get_stats(&ctx);
+    if (err || stats->strings != expect_strings || stats->direct_strings != expect_direct) {
+        fprintf(stderr, "%d: string stats test: got %d of %d direct strings (%s), expected %d of %d\n",
+                line, (int)stats->direct_strings, (int)stats->strings,
+                flatcc_json_parser_error_string(err), (int)expect_direct, (int)expect_strings);
+        return -1;
+    }
+    return 0;
+}
+
+#define TEST_STRING_STATS(x, ndjson, strings, direct) \
+    ret |= test_string_stats(scope, (x), (ndjson), (strings), (direct), __LINE__);
+
+int string_stats_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST_STRING_STATS("{ \"name\": \"Monster\" }", 0, 1, 1);
+    TEST_STRING_STATS("{ \"name\": \"\" }", 0, 1, 1);
+    TEST_STRING_STATS("{ \"name\": \"" LONG_64 "\\n\" }", 0, 1, 0);
+    TEST_STRING_STATS("{ \"name\": \"Monster\", \"testarrayofstring\": "
+            "[ \"a\", \"b\\tc\", \"" LONG_64 "\", \"\\u00e6\" ] }", 0, 5, 3);
+    /* NDJSON stats cover all lines. */
+    TEST_STRING_STATS("{\"name\":\"a\"}\n{\"name\":\"\\\"b\\\"\"}\n{\"name\":\"c\"}\n",
+            1, 3, 2);
+
+    END_TEST();
+}
+
+struct run_count {
+    size_t jobs;
+    size_t runs;
+};
+
+/*
+ * Runs jobs last to first to show that the order does not matter, and
+ * counts the jobs and runs. Parser and printer jobs have the same type,
+ * so both use this runner.
+ */
+static void run_reversed(void *run_context, flatcc_json_parser_job_f *job, void *job_context, size_t count)
+{
+    struct run_count *R = run_context;
+
+    R->jobs += count;
+    ++R->runs;
+    while (count--) {
+        job(job_context, count);
+    }
+}
+
+/*
+ * Parsing table vectors in parallel must give the same output, error and
+ * error location as parsing serially.
+ */
+int test_parallel(const struct test_scope *scope, const char *json, size_t chunk_size,
+        size_t expect_jobs, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t ctx, parallel_ctx;
+    flatcc_json_parser_parallel_t parallel;
+    flatcc_json_printer_t printer_ctx;
+    void *flatbuffer[2] = { 0, 0 };
+    char *text[2] = { 0, 0 };
+    struct run_count R = { 0, 0 };
+    size_t size;
+    int i, err[2], ret = -1;
+
+    parallel.run = run_reversed;
+    parallel.run_context = &R;
+    parallel.chunk_size = chunk_size;
+    parallel.batch_size = 0;
+    for (i = 0; i < 2; ++i) {
+        flatcc_builder_init(&builder);
+        if (i == 0) {
+            err[i] = flatcc_json_parser_table_as_root(&builder, &ctx, json, strlen(json), 0,
+                    scope->identifier, scope->parser);
+        } else {
+            err[i] = flatcc_json_parser_table_as_root_parallel(&builder, &parallel_ctx, json, strlen(json), 0,
+                    scope->identifier, scope->parser, &parallel);
+        }
+        if (!err[i]) {
+            flatbuffer[i] = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+            if (flatcc_verify_table_as_root(flatbuffer[i], size, scope->identifier, scope->verifier)) {
+                fprintf(stderr, "%d: parallel test: buffer verification failed\n", line);
+                flatcc_builder_clear(&builder);
+                goto done;
+            }
+            flatcc_json_printer_init_dynamic_buffer(&printer_ctx, 0);
+            flatcc_json_printer_table_as_root(&printer_ctx, flatbuffer[i], size, scope->identifier, scope->printer);
+            text[i] = flatcc_json_printer_finalize_dynamic_buffer(&printer_ctx, &size);
+        }
+        flatcc_builder_clear(&builder);
+    }
+    if (err[0] != err[1] || (err[0] && (ctx.line != parallel_ctx.line || ctx.pos != parallel_ctx.pos))) {
+        fprintf(stderr, "%d: parallel test: parse failed with: %s at %d:%d\n",
+                line, flatcc_json_parser_error_string(err[1]), parallel_ctx.line, parallel_ctx.pos);
+        fprintf(stderr, "but expected: %s at %d:%d\n",
+                flatcc_json_parser_error_string(err[0]), ctx.line, ctx.pos);
+        goto done;
+    }
+    if (!err[0] && (!text[0] || !text[1] || strcmp(text[0], text[1]))) {
+        fprintf(stderr, "%d: parallel test: got:\n%s\nexpected:\n%s\n", line, text[1], text[0]);
+        goto done;
+    }
+    if (R.jobs != expect_jobs) {
+        fprintf(stderr, "%d: parallel test: ran %d jobs, expected %d\n", line, (int)R.jobs, (int)expect_jobs);
+        goto done;
+    }
+    ret = 0;
+done:
+    for (i = 0; i < 2; ++i) {
+        flatcc_builder_aligned_free(flatbuffer[i]);
+        free(text[i]);
+    }
+    return ret;
+}
+
+#define TEST_PARALLEL(x, chunk_size, jobs) \
+    ret |= test_parallel(scope, (x), (chunk_size), (jobs), __LINE__);
+
+int parallel_tests(void)
+{
+    char json[8000];
+    char *p;
+    int i;
+
+    BEGIN_TEST(Monster);
+
+    p = json + sprintf(json, "{ \"name\": \"root\", \"testarrayoftables\": [");
+    for (i = 0; i < 40; ++i) {
+        p += sprintf(p, "%s\n  { \"name\": \"m%d\", \"hp\": %d, \"testarrayofstring\": [\"a\\n[{\", \"x\"],\r\n"
+                "    \"testarrayoftables\": [{ \"name\": \"inner\" }], \"test_type\": \"Monster\", \"test\": { \"name\": \"u\" } }",
+                i ? "," : "", i, i);
+    }
+    sprintf(p, "\n],\n\"hp\": 7 }");
+    /* Each element is a bit over 150 bytes. */
+    TEST_PARALLEL(json, 300, 20);
+    TEST_PARALLEL(json, 1, 40);
+    /* The vector is too small to split. */
+    TEST_PARALLEL(json, 5000, 0);
+    /* Lines are counted across ranges. */
+    sprintf(p, "\n],\n\"hp\": \"x\" }");
+    TEST_PARALLEL(json, 300, 20);
+    /* A failing range falls back to a serial parse that reports the error. */
+    sprintf(p, ",\n  { \"name\": \"bad\", \"hp\": \"x\" }\n] }");
+    TEST_PARALLEL(json, 300, 21);
+    sprintf(p, "\n  { \"name\": \"bad\" }\n] }");
+    TEST_PARALLEL(json, 300, 21);
+    /* Table vectors in any table can be split. */
+    TEST_PARALLEL("{ \"name\": \"root\", \"test_type\": \"Monster\", \"test\": { \"name\": \"u\","
+            " \"testarrayoftables\": [{ \"name\": \"a\" }, { \"name\": \"b\" }, { \"name\": \"c\" }] } }", 10, 3);
+    TEST_PARALLEL("{ \"name\": \"root\", \"testarrayoftables\": [] }", 1, 0);
+
+    END_TEST();
+}
+
+/*
+ * Printing table vectors in parallel must give the same output and
+ * error as printing serially, compact and pretty printed, and with a
+ * fixed buffer that may be too small. Jobs are run in `expect_runs`
+ * batches of at most `batch_size` jobs.
+ */
+int test_parallel_print(const struct test_scope *scope, const char *json, size_t chunk_size,
+        size_t batch_size, size_t expect_jobs, size_t expect_runs, size_t fixed_size, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_printer_t printer_ctx;
+    flatcc_json_printer_parallel_t parallel;
+    void *flatbuffer = 0;
+    char *text[2] = { 0, 0 };
+    static char fixed[2][20000];
+    struct run_count R;
+    size_t size, text_size;
+    int i, pretty, err[2], ret = -1;
+
+    flatcc_builder_init(&builder);
+    if (flatcc_json_parser_table_as_root(&builder, 0, json, strlen(json), 0,
+            scope->identifier, scope->parser)) {
+        fprintf(stderr, "%d: parallel print test: parse failed\n", line);
+        goto done;
+    }
+    flatbuffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+    parallel.run = run_reversed;
+    parallel.run_context = &R;
+    parallel.chunk_size = chunk_size;
+    parallel.batch_size = batch_size;
+    for (pretty = 0; pretty < 2; ++pretty) {
+        R.jobs = 0;
+        R.runs = 0;
+        for (i = 0; i < 2; ++i) {
+            if (fixed_size) {
+                flatcc_json_printer_init_buffer(&printer_ctx, fixed[i], fixed_size);
+            } else {
+                flatcc_json_printer_init_dynamic_buffer(&printer_ctx, 0);
+            }
+            if (pretty) {
+                flatcc_json_printer_set_nonstrict(&printer_ctx);
+            }
+            flatcc_json_printer_set_parallel(&printer_ctx, i ? &parallel : 0);
+            flatcc_json_printer_table_as_root(&printer_ctx, flatbuffer, size, scope->identifier, scope->printer);
+            err[i] = flatcc_json_printer_get_error(&printer_ctx);
+            if (fixed_size) {
+                text[i] = err[i] ? 0 : fixed[i];
+            } else {
+                text[i] = flatcc_json_printer_finalize_dynamic_buffer(&printer_ctx, &text_size);
+            }
+        }
+        if (err[0] != err[1]) {
+            fprintf(stderr, "%d: parallel print test: print failed with: %s\n",
+                    line, flatcc_json_printer_error_string(err[1]));
+            fprintf(stderr, "but expected: %s\n", flatcc_json_printer_error_string(err[0]));
+            goto done;
+        }
+        if (!err[0] && (!text[0] || !text[1] || strcmp(text[0], text[1]))) {
+            fprintf(stderr, "%d: parallel print test: got:\n%s\nexpected:\n%s\n", line, text[1], text[0]);
+            goto done;
+        }
+        if (R.jobs != expect_jobs || R.runs != expect_runs) {
+            fprintf(stderr, "%d: parallel print test: ran %d jobs in %d runs, expected %d in %d\n",
+                    line, (int)R.jobs, (int)R.runs, (int)expect_jobs, (int)expect_runs);
+            goto done;
+        }
+        if (!fixed_size) {
+            for (i = 0; i < 2; ++i) {
+                free(text[i]);
+                text[i] = 0;
+            }
+        }
+    }
+    ret = 0;
+done:
+    if (!fixed_size) {
+        for (i = 0; i < 2; ++i) {
+            free(text[i]);
+        }
+    }
+    flatcc_builder_aligned_free(flatbuffer);
+    flatcc_builder_clear(&builder);
+    return ret;
+}
+
+#define TEST_PARALLEL_PRINT(x, chunk_size, batch_size, jobs, runs, fixed_size) \
+    ret |= test_parallel_print(scope, (x), (chunk_size), (batch_size), (jobs), (runs), (fixed_size), __LINE__);
+
+int parallel_print_tests(void)
+{
+    char json[8000];
+    char *p;
+    int i;
+
+    BEGIN_TEST(Monster);
+
+    p = json + sprintf(json, "{ \"name\": \"root\", \"testarrayoftables\": [");
+    for (i = 0; i < 40; ++i) {
+        p += sprintf(p, "%s{ \"name\": \"m%d\", \"hp\": %d, \"testarrayofstring\": [\"a\", \"x\"],"
+                " \"testarrayoftables\": [{ \"name\": \"i1\" }, { \"name\": \"i2\" }] }",
+                i ? "," : "", i, i);
+    }
+    sprintf(p, "], \"hp\": 7 }");
+    TEST_PARALLEL_PRINT(json, 3, 0, 14, 1, 0);
+    /* Jobs print inner table vectors serially, so only the outer vector is split. */
+    TEST_PARALLEL_PRINT(json, 1, 0, 40, 3, 0);
+    /* The vector is too small to split. */
+    TEST_PARALLEL_PRINT(json, 21, 0, 0, 0, 0);
+    TEST_PARALLEL_PRINT(json, 20, 0, 2, 1, 0);
+    /* Batches are written in order, the last batch may be short. */
+    TEST_PARALLEL_PRINT(json, 3, 4, 14, 4, 0);
+    TEST_PARALLEL_PRINT(json, 3, 1, 14, 14, 0);
+    TEST_PARALLEL_PRINT(json, 1, 40, 40, 1, 0);
+    /* Overflow is reported as when printing serially. */
+    TEST_PARALLEL_PRINT(json, 3, 0, 14, 1, 1000);
+    TEST_PARALLEL_PRINT(json, 3, 0, 14, 1, 20000);
+    /* No batches are started after the output overflows. */
+    TEST_PARALLEL_PRINT(json, 3, 1, 1, 1, 200);
+    TEST_PARALLEL_PRINT(json, 3, 4, 14, 4, 20000);
+    /* Table vectors in any table can be split. */
+    TEST_PARALLEL_PRINT("{ \"name\": \"root\", \"test_type\": \"Monster\", \"test\": { \"name\": \"u\","
+            " \"testarrayoftables\": [{ \"name\": \"a\" }, { \"name\": \"b\" }, { \"name\": \"c\" }] } }", 1, 0, 3, 1, 0);
+    TEST_PARALLEL_PRINT("{ \"name\": \"root\", \"testarrayoftables\": [] }", 1, 0, 0, 0, 0);
+
+    END_TEST();
+}
+
+/*
+ * Parsing NDJSON in parallel must emit the same buffers in the same
+ * order, and report the same error, line, position and stats, as
+ * parsing serially.
+ */
+int test_ndjson_parallel(const struct test_scope *scope, const char *json, size_t chunk_size,
+        size_t batch_size, const char *expect, size_t expect_count,
+        size_t expect_jobs, size_t expect_runs, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t ctx[2];
+    flatcc_json_parser_parallel_t parallel;
+    struct ndjson_output out[2];
+    struct run_count R = { 0, 0 };
+    size_t count[2];
+    int i, err[2];
+
+    parallel.run = run_reversed;
+    parallel.run_context = &R;
+    parallel.chunk_size = chunk_size;
+    parallel.batch_size = batch_size;
+    for (i = 0; i < 2; ++i) {
+        memset(&out[i], 0, sizeof(out[i]));
+        out[i].scope = scope;
+        flatcc_builder_init(&builder);
+        err[i] = flatcc_json_parser_ndjson_parallel(&builder, &ctx[i], json, strlen(json), 0,
+                scope->identifier, scope->parser, ndjson_emit, &out[i], &count[i], i ? &parallel : 0);
+        flatcc_builder_clear(&builder);
+    }
+    if (err[0] != err[1] || (err[0] && (ctx[0].line != ctx[1].line || ctx[0].pos != ctx[1].pos))) {
+        fprintf(stderr, "%d: ndjson parallel test: parse failed with: %s at %d:%d\n",
+                line, flatcc_json_parser_error_string(err[1]), ctx[1].line, ctx[1].pos);
+        fprintf(stderr, "but expected: %s at %d:%d\n",
+                flatcc_json_parser_error_string(err[0]), ctx[0].line, ctx[0].pos);
+        return -1;
+    }
+    if (memcmp(&ctx[0].stats, &ctx[1].stats, sizeof(ctx[0].stats))) {
+        fprintf(stderr, "%d: ndjson parallel test: stats differ\n", line);
+        return -1;
+    }
+    if (count[0] != expect_count || count[1] != expect_count
+            || strcmp(out[0].text, expect) || strcmp(out[1].text, expect)) {
+        fprintf(stderr, "%d: ndjson parallel test: got %d buffers:\n%s", line, (int)count[1], out[1].text);
+        fprintf(stderr, "expected %d buffers:\n%s", (int)expect_count, expect);
+        return -1;
+    }
+    if (R.jobs != expect_jobs || R.runs != expect_runs) {
+        fprintf(stderr, "%d: ndjson parallel test: ran %d jobs in %d runs, expected %d in %d\n",
+                line, (int)R.jobs, (int)R.runs, (int)expect_jobs, (int)expect_runs);
+        return -1;
+    }
+    return 0;
+}
+
+#define TEST_NDJSON_PARALLEL(x, chunk_size, batch_size, y, count, jobs, runs) \
+    ret |= test_ndjson_parallel(scope, (x), (chunk_size), (batch_size), (y), (count), (jobs), (runs), __LINE__);
+
+#define NDJSON_FAILING_INPUT                                                \
+    "{\"name\":\"a\"}\n"                                                    \
+    "{\"name\":\"b\", \"testarrayofstring\": [\"x\\ty\"]}\n"                 \
+    "\n"                                                                    \
+    "{\"name\":\"c\" \"hp\": 1}\n"                                          \
+    "{\"name\":\"d\"}\n"
+
+int ndjson_parallel_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    /* Short input is parsed serially. */
+    TEST_NDJSON_PARALLEL(NDJSON_INPUT, 1000, 0, NDJSON_OUTPUT, 4, 0, 0);
+    TEST_NDJSON_PARALLEL("", 1, 0, "", 0, 0, 0);
+    TEST_NDJSON_PARALLEL(NDJSON_INPUT, 10, 0, NDJSON_OUTPUT, 4, 4, 1);
+    TEST_NDJSON_PARALLEL(NDJSON_INPUT, 30, 0, NDJSON_OUTPUT, 4, 2, 1);
+    /* Buffers of each batch are emitted before the next batch runs. */
+    TEST_NDJSON_PARALLEL(NDJSON_INPUT, 10, 2, NDJSON_OUTPUT, 4, 4, 2);
+    TEST_NDJSON_PARALLEL(NDJSON_INPUT, 10, 1, NDJSON_OUTPUT, 4, 4, 4);
+    /* Lines before the error are emitted, and no batch runs after it. */
+    TEST_NDJSON_PARALLEL(NDJSON_FAILING_INPUT, 10, 0, "{\"name\":\"a\"}\n{\"name\":\"b\",\"testarrayofstring\":[\"x\\ty\"]}\n", 2, 4, 1);
+    TEST_NDJSON_PARALLEL(NDJSON_FAILING_INPUT, 10, 1, "{\"name\":\"a\"}\n{\"name\":\"b\",\"testarrayofstring\":[\"x\\ty\"]}\n", 2, 3, 3);
+
+    END_TEST();
+}
+
+/*
+ * Prints with a projection built from `paths`, a list of field id paths
+ * each ending with -1, and the list ending with an empty path.
+ */
+int test_projection(const struct test_scope *scope, const char *json, const int *paths,
+        flatcc_json_printer_flags_t flags, const char *expect, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_printer_t printer_ctx;
+    flatcc_json_printer_projection_t projection;
+    void *flatbuffer = 0;
+    char *text = 0;
+    size_t size, depth;
+    int ret = -1;
+
+    flatcc_json_printer_projection_init(&projection);
+    flatcc_builder_init(&builder);
+    while (paths[0] >= 0) {
+        for (depth = 0; paths[depth] >= 0; ++depth) {}
+        if (flatcc_json_printer_projection_add(&projection, paths, depth)) {
+            fprintf(stderr, "%d: projection test: could not add path\n", line);
+            goto done;
+        }
+        paths += depth + 1;
+    }
+    if (flatcc_json_parser_table_as_root(&builder, 0, json, strlen(json), 0,
+            scope->identifier, scope->parser)) {
+        fprintf(stderr, "%d: projection test: parse failed\n", line);
+        goto done;
+    }
+    flatbuffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+    flatcc_json_printer_init_dynamic_buffer(&printer_ctx, 0);
+    flatcc_json_printer_set_flags(&printer_ctx, flags);
+    flatcc_json_printer_set_projection(&printer_ctx, &projection);
+    flatcc_json_printer_table_as_root(&printer_ctx, flatbuffer, size, scope->identifier, scope->printer);
+    text = flatcc_json_printer_finalize_dynamic_buffer(&printer_ctx, &size);
+    if (!text || strcmp(text, expect)) {
+        fprintf(stderr, "%d: projection test: got:\n%s\nexpected:\n%s\n", line, text, expect);
+        goto done;
+    }
+    ret = 0;
+done:
+    free(text);
+    flatcc_json_printer_projection_clear(&projection);
+    flatcc_builder_aligned_free(flatbuffer);
+    flatcc_builder_clear(&builder);
+    return ret;
+}
+
+#define TEST_PROJECTION(x, paths, fprint, y) \
+    ret |= test_projection(scope, (x), (paths), (fprint), (y), __LINE__);
+
+#define PATHS(...) ((const int []){ __VA_ARGS__, -1 })
+
+int projection_tests(void)
+{
+    const char *json = "{ \"name\": \"root\", \"hp\": 1, \"color\": \"Red\", \"testarrayoftables\": ["
+            "{ \"name\": \"a\", \"hp\": 2 }, { \"name\": \"b\", \"hp\": 3 }],"
+            "\"test_type\": \"Monster\", \"test\": { \"name\": \"u\", \"hp\": 4 },"
+            "\"enemy\": { \"name\": \"e\", \"enemy\": { \"name\": \"f\", \"hp\": 5 } },"
+            "\"testnestedflatbuffer\": { \"name\": \"n\", \"hp\": 6 } }";
+    int tables = ns(Monster_testarrayoftables_field_id);
+    int name = ns(Monster_name_field_id);
+    int hp = ns(Monster_hp_field_id);
+    int enemy = ns(Monster_enemy_field_id);
+
+    BEGIN_TEST(Monster);
+
+    TEST_PROJECTION(json, PATHS(name, -1), 0, "{\"name\":\"root\"}");
+    TEST_PROJECTION(json, PATHS(-1), 0, "{}");
+    /* Fields print in field id order regardless of selection order. */
+    TEST_PROJECTION(json, PATHS(tables, name, -1, hp, -1), 0,
+            "{\"hp\":1,\"testarrayoftables\":[{\"name\":\"a\"},{\"name\":\"b\"}]}");
+    /* A field selected in full is not narrowed, whatever the order. */
+    TEST_PROJECTION(json, PATHS(tables, name, -1, tables, -1), 0,
+            "{\"testarrayoftables\":[{\"hp\":2,\"name\":\"a\"},{\"hp\":3,\"name\":\"b\"}]}");
+    TEST_PROJECTION(json, PATHS(tables, -1, tables, name, -1), 0,
+            "{\"testarrayoftables\":[{\"hp\":2,\"name\":\"a\"},{\"hp\":3,\"name\":\"b\"}]}");
+    TEST_PROJECTION(json, PATHS(enemy, enemy, hp, -1, enemy, name, -1), 0,
+            "{\"enemy\":{\"name\":\"e\",\"enemy\":{\"hp\":5}}}");
+    /* Unions print their type with the member. */
+    TEST_PROJECTION(json, PATHS(ns(Monster_test_field_id), hp, -1), 0,
+            "{\"test_type\":\"Monster\",\"test\":{\"hp\":4}}");
+    TEST_PROJECTION(json, PATHS(ns(Monster_testnestedflatbuffer_field_id), name, -1), 0,
+            "{\"testnestedflatbuffer\":{\"name\":\"n\"}}");
+    /* Defaults are only forced for selected fields. */
+    TEST_PROJECTION(json, PATHS(name, -1, ns(Monster_mana_field_id), -1),
+            flatcc_json_printer_f_force_default, "{\"mana\":150,\"name\":\"root\"}");
+    TEST_PROJECTION(json, PATHS(tables, ns(Monster_mana_field_id), -1),
+            flatcc_json_printer_f_force_default,
+            "{\"testarrayoftables\":[{\"mana\":150},{\"mana\":150}]}");
+
+    END_TEST();
+}
+
+int union_vector_projection_tests(void)
+{
+    BEGIN_TEST(Alt);
+
+    TEST_PROJECTION("{ \"manyany_type\": [ \"Monster\", \"NONE\" ],"
+            " \"manyany\": [{\"name\": \"Joe\", \"hp\": 7}, null], \"names\": [\"x\"] }",
+            PATHS(ns(Alt_manyany_field_id), ns(Monster_hp_field_id), -1), 0,
+            "{\"manyany_type\":[\"Monster\",\"NONE\"],\"manyany\":[{\"hp\":7},null]}");
+
+    END_TEST();
+}
+
 /*
  * Here we cover some border cases around unions and flag
  * enumerations, and nested buffers.
@@ -591,7 +1661,22 @@ int main(void)
     ret |= union_vector_tests();
     ret |= fixed_array_tests();
     ret |= base64_tests();
+    ret |= large_base64_tests();
     ret |= mixed_type_union_tests();
+    ret |= long_string_tests();
+    ret |= long_char_array_tests();
+    ret |= ndjson_tests();
+    ret |= union_skip_tests();
+    ret |= union_vector_skip_tests();
+    ret |= number_tests();
+    ret |= numeric_vector_tests();
+    ret |= string_stats_tests();
+    ret |= parallel_tests();
+    ret |= parallel_print_tests();
+    ret |= ndjson_parallel_tests();
+    ret |= ndjson_print_tests();
+    ret |= projection_tests();
+    ret |= union_vector_projection_tests();
 
     /* Allow trailing comma. */
     TEST(   "{ \"name\": \"Monster\", }",
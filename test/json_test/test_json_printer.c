@@ -23,6 +23,355 @@ const char *filename = 0; /* "monsterdata_test.mon"; */
 const char *golden_filename = "monsterdata_test.golden";
 const char *target_filename = "monsterdata_test.json.txt";
 
+struct writer_output {
+    char *buf;
+    size_t size;
+    /* The previous write which must not change until the next write returns. */
+    const char *pending;
+    char pending_copy[256];
+    size_t pending_size;
+    int writes;
+    int syncs;
+    int error;
+};
+
+static int test_write(void *write_context, const char *data, size_t len)
+{
+    struct writer_output *out = write_context;
+
+    if (out->pending && memcmp(out->pending, out->pending_copy, out->pending_size)) {
+        out->error = 1;
+    }
+    out->pending = 0;
+    if (!data) {
+        ++out->syncs;
+        return 0;
+    }
+    if (len > sizeof(out->pending_copy) || !(out->buf = realloc(out->buf, out->size + len + 1))) {
+        out->error = 1;
+        return -1;
+    }
+    memcpy(out->buf + out->size, data, len);
+    out->size += len;
+    out->buf[out->size] = '\0';
+    memcpy(out->pending_copy, data, len);
+    out->pending = data;
+    out->pending_size = len;
+    ++out->writes;
+    return 0;
+}
+
+/*
+ * Prints through the double buffered writer with small buffers so
+ * there are many writes, and checks that a buffer being written is left
+ * alone until the next write.
+ */
+int test_print_writer(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    int ret = -1;
+    struct writer_output out;
+    flatcc_json_printer_t ctx_obj, *ctx;
+
+    ctx = &ctx_obj;
+    memset(&out, 0, sizeof(out));
+    if (flatcc_json_printer_init_writer(ctx, test_write, &out, 150)) {
+        fprintf(stderr, "could not initialize json writer\n");
+        return -1;
+    }
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx) || out.error) {
+        fprintf(stderr, "could not print monster data with json writer\n");
+        goto done;
+    }
+    if (out.syncs != 1 || out.writes < (int)(golden_size / 150)) {
+        fprintf(stderr, "json writer: unexpected %d writes and %d syncs\n", out.writes, out.syncs);
+        goto done;
+    }
+    if (out.size != golden_size || memcmp(out.buf, golden, golden_size)) {
+        fprintf(stderr, "json writer output did not match verification file\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_json_printer_clear(ctx);
+    free(out.buf);
+    return ret;
+}
+
+/*
+ * Measures the printed size, then prints into a buffer of exactly the
+ * size needed, which must neither overflow nor grow, while one byte
+ * less must overflow.
+ */
+int test_print_measured(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    int ret = -1;
+    int printed;
+    char *out = 0, *dyn = 0;
+    size_t out_size, dyn_size;
+    flatcc_json_printer_t ctx_obj, *ctx;
+
+    ctx = &ctx_obj;
+    if (flatcc_json_printer_init_measure(ctx)) {
+        fprintf(stderr, "could not initialize json measure\n");
+        return -1;
+    }
+    flatcc_json_printer_set_nonstrict(ctx);
+    printed = ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    flatcc_json_printer_clear(ctx);
+    if (printed < 0 || (size_t)printed != golden_size) {
+        fprintf(stderr, "json measure: got size %d, expected %d\n", printed, (int)golden_size);
+        return -1;
+    }
+    out_size = flatcc_json_printer_buffer_size_for((size_t)printed);
+    if (!(out = malloc(out_size))) {
+        return -1;
+    }
+    flatcc_json_printer_init_buffer(ctx, out, out_size);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx) || strlen(out) != golden_size || memcmp(out, golden, golden_size)) {
+        fprintf(stderr, "json measure: output did not fit measured buffer\n");
+        goto done;
+    }
+    flatcc_json_printer_init_buffer(ctx, out, out_size - 1);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx) != flatcc_json_printer_error_overflow) {
+        fprintf(stderr, "json measure: measured buffer size is not tight\n");
+        goto done;
+    }
+    flatcc_json_printer_init_dynamic_buffer(ctx, out_size);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (ctx->size != out_size) {
+        fprintf(stderr, "json measure: dynamic buffer was reallocated\n");
+        flatcc_json_printer_clear(ctx);
+        goto done;
+    }
+    dyn = flatcc_json_printer_finalize_dynamic_buffer(ctx, &dyn_size);
+    if (!dyn || dyn_size != golden_size || memcmp(dyn, golden, golden_size)) {
+        fprintf(stderr, "json measure: dynamic buffer output did not match verification file\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    free(out);
+    free(dyn);
+    return ret;
+}
+
+struct iovec_output {
+    char *buf;
+    size_t size;
+    size_t chunk_size;
+    int calls;
+    int error;
+};
+
+static int test_iovec(void *iovec_context, const flatcc_json_printer_iovec_t *iov, int iovcnt)
+{
+    struct iovec_output *out = iovec_context;
+    int i;
+
+    for (i = 0; i < iovcnt; ++i) {
+        if (iov[i].iov_len > out->chunk_size || !(out->buf = realloc(out->buf, out->size + iov[i].iov_len + 1))) {
+            out->error = 1;
+            return -1;
+        }
+        memcpy(out->buf + out->size, iov[i].iov_base, iov[i].iov_len);
+        out->size += iov[i].iov_len;
+        out->buf[out->size] = '\0';
+    }
+    ++out->calls;
+    return 0;
+}
+
+/*
+ * Prints into a small ring of chunks handed to a callback whenever the
+ * ring is full, then into a ring large enough to collect the output
+ * without a callback, and into one too small.
+ */
+int test_print_iovec(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    int ret = -1;
+    int i, n, printed;
+    struct iovec_output out;
+    static char mem[64][256];
+    char *chunks[64];
+    const flatcc_json_printer_iovec_t *iov;
+    flatcc_json_printer_t ctx_obj, *ctx;
+
+    ctx = &ctx_obj;
+    memset(&out, 0, sizeof(out));
+    out.chunk_size = sizeof(mem[0]);
+    for (i = 0; i < 64; ++i) {
+        chunks[i] = mem[i];
+    }
+    if (flatcc_json_printer_init_iovec(ctx, chunks, 3, sizeof(mem[0]), test_iovec, &out)) {
+        fprintf(stderr, "could not initialize json iovec printer\n");
+        return -1;
+    }
+    flatcc_json_printer_set_nonstrict(ctx);
+    printed = ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx) || out.error || printed != (int)golden_size) {
+        fprintf(stderr, "could not print monster data with json iovec printer\n");
+        goto done;
+    }
+    if (out.calls < (int)(golden_size / (3 * sizeof(mem[0])))) {
+        fprintf(stderr, "json iovec: unexpected %d calls\n", out.calls);
+        goto done;
+    }
+    if (out.size != golden_size || memcmp(out.buf, golden, golden_size)) {
+        fprintf(stderr, "json iovec output did not match verification file\n");
+        goto done;
+    }
+    flatcc_json_printer_clear(ctx);
+    flatcc_json_printer_init_iovec(ctx, chunks, 64, sizeof(mem[0]), 0, 0);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    iov = flatcc_json_printer_get_iovec(ctx, &n);
+    out.size = 0;
+    if (flatcc_json_printer_get_error(ctx) || test_iovec(&out, iov, n)) {
+        fprintf(stderr, "could not collect monster data from json iovec printer\n");
+        goto done;
+    }
+    if (n < 2 || out.size != golden_size || memcmp(out.buf, golden, golden_size)) {
+        fprintf(stderr, "json iovec collected output did not match verification file\n");
+        goto done;
+    }
+    flatcc_json_printer_clear(ctx);
+    flatcc_json_printer_init_iovec(ctx, chunks, n - 1, sizeof(mem[0]), 0, 0);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx) != flatcc_json_printer_error_overflow) {
+        fprintf(stderr, "json iovec: ring of %d chunks did not overflow\n", n - 1);
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_json_printer_clear(ctx);
+    free(out.buf);
+    return ret;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+static int test_writev(void *iovec_context, const flatcc_json_printer_iovec_t *iov, int iovcnt)
+{
+    ssize_t n = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; ++i) {
+        n -= (ssize_t)iov[i].iov_len;
+    }
+    /* A regular file is written in whole. */
+    return writev(*(int *)iovec_context, (const struct iovec *)iov, iovcnt) + n != 0;
+}
+
+/* Prints to the output file through its file descriptor, bypassing stdio. */
+int test_print_fd(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    int ret = -1;
+    const char *target = 0;
+    size_t target_size = 0;
+    flatcc_json_printer_t ctx_obj, *ctx;
+    int fd;
+
+    ctx = &ctx_obj;
+    fd = open(target_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "%s: could not open output file\n", target_filename);
+        return -1;
+    }
+    if (flatcc_json_printer_init_fd(ctx, fd)) {
+        fprintf(stderr, "could not initialize json fd printer\n");
+        close(fd);
+        return -1;
+    }
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx)) {
+        fprintf(stderr, "could not print monster data to file descriptor\n");
+    }
+    flatcc_json_printer_clear(ctx);
+    close(fd);
+    target = readfile(target_filename, FILE_SIZE_MAX, &target_size);
+    if (!target || target_size != golden_size || memcmp(target, golden, target_size)) {
+        fprintf(stderr, "file descriptor output did not match verification file\n");
+    } else {
+        ret = 0;
+    }
+    if (target) {
+        free((void *)target);
+    }
+    return ret;
+}
+
+/* Passes chunks straight to `writev`. */
+int test_print_writev(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    int ret = -1;
+    const char *target = 0;
+    size_t target_size = 0;
+    static char mem[4][128];
+    char *chunks[4] = { mem[0], mem[1], mem[2], mem[3] };
+    flatcc_json_printer_t ctx_obj, *ctx;
+    int fd;
+
+    ctx = &ctx_obj;
+    fd = open(target_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "%s: could not open output file\n", target_filename);
+        return -1;
+    }
+    flatcc_json_printer_init_iovec(ctx, chunks, 4, sizeof(mem[0]), test_writev, &fd);
+    flatcc_json_printer_set_nonstrict(ctx);
+    ns(Monster_print_json_as_root(ctx, buf, size, "MONS"));
+    if (flatcc_json_printer_get_error(ctx)) {
+        fprintf(stderr, "could not print monster data with writev\n");
+    }
+    flatcc_json_printer_clear(ctx);
+    close(fd);
+    target = readfile(target_filename, FILE_SIZE_MAX, &target_size);
+    if (!target || target_size != golden_size || memcmp(target, golden, target_size)) {
+        fprintf(stderr, "writev output did not match verification file\n");
+    } else {
+        ret = 0;
+    }
+    if (target) {
+        free((void *)target);
+    }
+    return ret;
+}
+
+#else
+
+int test_print_writev(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    (void)buf;
+    (void)size;
+    (void)golden;
+    (void)golden_size;
+    return 0;
+}
+
+int test_print_fd(const char *buf, size_t size, const char *golden, size_t golden_size)
+{
+    (void)buf;
+    (void)size;
+    (void)golden;
+    (void)golden_size;
+    return 0;
+}
+
+#endif
+
 int test_print(void)
 {
     int ret = 0;
@@ -82,6 +431,13 @@ int test_print(void)
         fprintf(stderr, "generated output file did not match verification file\n");
         goto fail;
     }
+    if (test_print_writer(buf, size, golden, golden_size) ||
+            test_print_fd(buf, size, golden, golden_size) ||
+            test_print_measured(buf, size, golden, golden_size) ||
+            test_print_iovec(buf, size, golden, golden_size) ||
+            test_print_writev(buf, size, golden, golden_size)) {
+        goto fail;
+    }
     fprintf(stderr, "json print test succeeded\n");
 
 done:
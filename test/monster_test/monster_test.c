@@ -898,6 +898,146 @@ int test_monster(flatcc_builder_t *B)
     return ret;
 }
 
+/*
+ * Corruption within the bytes received so far must fail with its own
+ * error rather than wait for more data.
+ */
+int test_verify_partial_corrupt(const void *frame, size_t size)
+{
+    struct flatcc_verify_visited_item items[64];
+    flatcc_verify_visited_t visited;
+    uint8_t *copy;
+    size_t table, received;
+    int ret = -1;
+
+    if (!(copy = flatcc_builder_aligned_alloc(16, size))) {
+        return -1;
+    }
+    memcpy(copy, frame, size);
+    /* The root table follows the size prefix, the root offset and the identifier. */
+    table = sizeof(flatbuffers_uoffset_t) + __flatbuffers_uoffset_read_from_pe(copy + sizeof(flatbuffers_uoffset_t));
+    received = table + sizeof(flatbuffers_soffset_t);
+    if (received >= size) {
+        printf("partial Monster test expected the root table early in the buffer\n");
+        goto done;
+    }
+    /* An odd vtable offset is unaligned however much data follows. */
+    __flatbuffers_soffset_write_to_pe(copy + table, __flatbuffers_soffset_read_from_pe(copy + table) + 1);
+    memset(items, 0, sizeof(items));
+    flatcc_verify_visited_init(&visited, items, c_vec_len(items));
+    ret = ns(Monster_verify_as_root_with_size_partial(copy, received, &visited));
+    if (ret != flatcc_verify_error_vtable_offset_out_of_range_or_unaligned) {
+        printf("partial Monster buffer with corrupt vtable offset in the first %d bytes did not fail, got: %s\n",
+                (int)received, flatcc_verify_error_string(ret));
+        ret = -1;
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(copy);
+    return ret;
+}
+
+int test_verify_partial(const void *frame, size_t size)
+{
+    struct flatcc_verify_visited_item items[64];
+    flatcc_verify_visited_t visited;
+    size_t received;
+    int ret = flatcc_verify_error_buffer_incomplete;
+
+    ret = ns(Monster_verify_as_root_with_size_partial(frame, size, 0));
+    if (ret != flatcc_verify_error_runtime_visited_set_missing) {
+        printf("partial Monster verifier accepted a missing visited set, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    memset(items, 0, sizeof(items));
+    flatcc_verify_visited_init(&visited, items, c_vec_len(items));
+    /* Simulate data arriving in small chunks. */
+    for (received = 0; received <= size; received += 7) {
+        ret = ns(Monster_verify_as_root_with_size_partial(frame, received, &visited));
+        if (ret == flatcc_verify_ok) {
+            break;
+        }
+        if (ret != flatcc_verify_error_buffer_incomplete) {
+            printf("partial Monster buffer failed to verify at %d of %d bytes, got: %s\n",
+                    (int)received, (int)size, flatcc_verify_error_string(ret));
+            return -1;
+        }
+    }
+    if (ret == flatcc_verify_error_buffer_incomplete) {
+        ret = ns(Monster_verify_as_root_with_size_partial(frame, size, &visited));
+    }
+    if (ret) {
+        printf("partial Monster buffer failed to verify when complete, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    if (visited.count == 0) {
+        printf("partial Monster verifier did not record any visited tables\n");
+        return -1;
+    }
+    return test_verify_partial_corrupt(frame, size);
+}
+
+int test_verify_diagnostics(flatcc_builder_t *B)
+{
+    void *buffer;
+    size_t size;
+    int ret = -1;
+    flatcc_verify_diagnostics_t diag;
+    ns(Monster_table_t) mon;
+    flatbuffers_string_t id;
+    const uint8_t *stat, *vt;
+    size_t offset;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_testempty_create(B, nsc(string_create_str(B, "hello")), -100, 2));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    if ((ret = ns(Monster_verify_as_root_with_diagnostics(buffer, size, &diag)))) {
+        printf("Monster buffer failed to verify with diagnostics, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    if (diag.error != flatcc_verify_ok || diag.depth != 0) {
+        printf("diagnostics reported a failure on a valid buffer\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(buffer));
+    id = ns(Stat_id(ns(Monster_testempty(mon))));
+    /* Offset of the Stat.id field which holds the offset to the string. */
+    stat = (const uint8_t *)ns(Monster_testempty(mon));
+    vt = stat - __flatbuffers_soffset_read_from_pe(stat);
+    offset = (size_t)(stat + __flatbuffers_voffset_read_from_pe(vt + 2 * sizeof(flatbuffers_voffset_t)) - (const uint8_t *)buffer);
+    /* Corrupt the string length so it exceeds the buffer. */
+    ((flatbuffers_uoffset_t *)id)[-1] = (flatbuffers_uoffset_t)size;
+
+    if (flatcc_verify_error_string_out_of_range != ns(Monster_verify_as_root_with_diagnostics(buffer, size, &diag))) {
+        printf("corrupted Monster buffer did not fail as expected\n");
+        goto done;
+    }
+    if (diag.error != flatcc_verify_error_string_out_of_range) {
+        printf("diagnostics did not record the error\n");
+        goto done;
+    }
+    if (diag.depth != 2 || diag.path[0].id != 0 || diag.path[1].id != 14
+            || strcmp(diag.path[0].type_name, "MyGame_Example_Stat")
+            || strcmp(diag.path[1].type_name, "MyGame_Example_Monster")) {
+        printf("diagnostics did not record the expected path\n");
+        goto done;
+    }
+    if (diag.offset != offset) {
+        printf("diagnostics reported offset %d, expected %d\n", (int)diag.offset, (int)offset);
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
 int test_monster_with_size(flatcc_builder_t *B)
 {
     void *buffer, *frame;
@@ -924,12 +1064,207 @@ int test_monster_with_size(flatcc_builder_t *B)
         printf("Monster buffer with size prefix failed to verify, got: %s\n", flatcc_verify_error_string(ret));
         return -1;
     }
+    /* The identifier follows the size field and the root offset. */
+    if ((ret = ns(Monster_verify_as_root_with_size(frame, size)))) {
+        printf("Monster buffer with size prefix failed to verify with size, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    ret = ns(Monster_verify_as_root_with_identifier_and_size(frame, size, "MONX"));
+    if (ret != flatcc_verify_error_identifier_mismatch) {
+        printf("Monster buffer with size prefix did not fail on identifier mismatch, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    size2 = size;
+    if ((ret = flatcc_verify_typed_buffer_header_with_size(frame, &size2, flatbuffers_type_hash_from_string("MONS")))) {
+        printf("Monster buffer with size prefix failed to verify typed header, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    size2 = size;
+    ret = flatcc_verify_typed_buffer_header_with_size(frame, &size2, flatbuffers_type_hash_from_string("MONX"));
+    if (ret != flatcc_verify_error_identifier_mismatch) {
+        printf("Monster buffer with size prefix did not fail on type hash mismatch, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
     ret = verify_monster(buffer);
+    if (ret == 0) {
+        ret = test_verify_partial(frame, size);
+    }
 
     flatcc_builder_aligned_free(frame);
     return ret;
 }
 
+int test_verify_visited(const void *buffer, size_t size)
+{
+    struct flatcc_verify_visited_item items[64], few_items[4];
+    flatcc_verify_visited_t visited;
+    size_t count;
+    int ret;
+
+    memset(items, 0, sizeof(items));
+    flatcc_verify_visited_init(&visited, items, c_vec_len(items));
+    if ((ret = ns(Monster_verify_as_root_with_visited(buffer, size, &visited)))) {
+        printf("Monster buffer failed to verify with visited set, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    if (visited.count == 0) {
+        printf("Monster verifier did not record any visited tables\n");
+        return -1;
+    }
+    count = visited.count;
+    /* Everything is already visited, so nothing new is recorded. */
+    if ((ret = ns(Monster_verify_as_root_with_visited(buffer, size, &visited)))) {
+        printf("Monster buffer failed to reverify with visited set, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    if (visited.count != count) {
+        printf("Monster verifier unexpectedly recorded more visited tables\n");
+        return -1;
+    }
+    flatcc_verify_visited_reset(&visited);
+    if (visited.count != 0 || items[0].table || items[c_vec_len(items) - 1].table) {
+        printf("visited set reset failed\n");
+        return -1;
+    }
+    /* A full set must still verify, just without recording. */
+    memset(few_items, 0, sizeof(few_items));
+    flatcc_verify_visited_init(&visited, few_items, c_vec_len(few_items));
+    if ((ret = ns(Monster_verify_as_root_with_visited(buffer, size, &visited)))) {
+        printf("Monster buffer failed to verify with small visited set, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
+    if (visited.count > 3) {
+        printf("small visited set exceeded its load factor\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Returns the location of a table field so tests can rewrite it. */
+static uint8_t *table_field_location(const void *t, flatbuffers_voffset_t id)
+{
+    __flatbuffers_read_vt(id, offset, t)
+    return offset ? (uint8_t *)t + offset : 0;
+}
+
+static void write_uoffset_to(uint8_t *p, const void *target)
+{
+    __flatbuffers_uoffset_write_to_pe(p, (flatbuffers_uoffset_t)((const uint8_t *)target - p));
+}
+
+/*
+ * Each monster references the previous monster three times, so the
+ * deepest monster is reached 3^depth times without a visited set.
+ */
+int test_verify_visited_dag(flatcc_builder_t *B)
+{
+    struct flatcc_verify_visited_item items[256];
+    flatcc_verify_visited_t visited;
+    ns(Monster_ref_t) mon = 0, *aoft;
+    ns(Monster_table_t) t;
+    void *buffer;
+    size_t size;
+    int i, depth = 40, ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    for (i = 0; i < depth; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_create_str(B, "Shared"));
+        if (mon) {
+            ns(Monster_enemy_add(B, mon));
+            ns(Monster_testarrayoftables_start(B));
+            aoft = ns(Monster_testarrayoftables_extend(B, 2));
+            aoft[0] = mon;
+            aoft[1] = mon;
+            ns(Monster_testarrayoftables_end(B));
+        }
+        mon = ns(Monster_end(B));
+    }
+    ns(Monster_enemy_add(B, mon));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    memset(items, 0, sizeof(items));
+    flatcc_verify_visited_init(&visited, items, c_vec_len(items));
+    if ((ret = ns(Monster_verify_as_root_with_visited(buffer, size, &visited)))) {
+        printf("Monster DAG failed to verify with visited set, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    if (visited.count != (size_t)depth + 1) {
+        printf("Monster DAG verifier recorded %d tables, expected %d\n", (int)visited.count, depth + 1);
+        goto done;
+    }
+    /* The shared monster at the bottom must still be verified. */
+    t = ns(Monster_as_root(buffer));
+    while (ns(Monster_enemy(t))) {
+        t = ns(Monster_enemy(t));
+    }
+    __flatbuffers_uoffset_write_to_pe(table_field_location(t, 3), (flatbuffers_uoffset_t)size);
+    flatcc_verify_visited_reset(&visited);
+    if (ns(Monster_verify_as_root_with_visited(buffer, size, &visited)) == flatcc_verify_ok) {
+        printf("Monster DAG with a corrupt shared monster verified with visited set\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/*
+ * The root monster of a nested buffer is also the enemy of the
+ * enclosing monster, and its name is the name of the enclosing monster.
+ * It verifies as part of the enclosing buffer, but the nested buffer
+ * is not self-contained and must fail with or without a visited set.
+ */
+int test_verify_visited_nested(flatcc_builder_t *B)
+{
+    struct flatcc_verify_visited_item items[64];
+    flatcc_verify_visited_t visited;
+    ns(Monster_table_t) mon, nested;
+    void *buffer;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "MyEnemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testnestedflatbuffer_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyNestedMonster"));
+    ns(Monster_testnestedflatbuffer_end_as_root(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    mon = ns(Monster_as_root(buffer));
+    nested = ns(Monster_testnestedflatbuffer_as_root(mon));
+    write_uoffset_to(table_field_location(mon, 12), nested);
+    write_uoffset_to(table_field_location(nested, 3), ns(Monster_name(mon)) - sizeof(flatbuffers_uoffset_t));
+    if (strcmp(ns(Monster_name(ns(Monster_enemy(mon)))), "MyMonster")) {
+        printf("Monster enemy was not redirected to the nested monster\n");
+        goto done;
+    }
+    if (ns(Monster_verify_as_root(buffer, size)) == flatcc_verify_ok) {
+        printf("Monster with a nested buffer that is not self-contained verified\n");
+        goto done;
+    }
+    memset(items, 0, sizeof(items));
+    flatcc_verify_visited_init(&visited, items, c_vec_len(items));
+    if (ns(Monster_verify_as_root_with_visited(buffer, size, &visited)) == flatcc_verify_ok) {
+        printf("Monster with a nested buffer that is not self-contained verified with visited set\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
 int test_cloned_monster(flatcc_builder_t *B)
 {
     void *buffer;
@@ -979,6 +1314,9 @@ int test_cloned_monster(flatcc_builder_t *B)
         printf("Cloned Monster did not have the expected content.");
         return -1;
     }
+    if ((ret = test_verify_visited(cloned_buffer, size))) {
+        return ret;
+    }
 
     flatcc_refmap_clear(&refmap);
     flatcc_builder_aligned_free(buffer);
@@ -2789,6 +3127,12 @@ int main(int argc, char *argv[])
         return -1;
     }
 #endif
+#if 1
+    if (test_verify_diagnostics(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
 #if 1
     if (test_string(B)) {
         printf("TEST FAILED\n");
@@ -2879,6 +3223,18 @@ int main(int argc, char *argv[])
         return -1;
     }
 #endif
+#if 1
+    if (test_verify_visited_dag(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_visited_nested(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
 #if 1
     if (verify_include(B)) {
         printf("TEST FAILED\n");